@@ -0,0 +1,65 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16u   // Enough for any scalar array / Suffisant pour tout tableau scalaire
+
+void *arenaAlloc(ScratchArena *a, size_t count, size_t size) {
+    if (size && count > (SIZE_MAX - ARENA_ALIGN) / size) {
+        fprintf(stderr, "arena allocation too large\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t bytes = (count * size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (bytes == 0) bytes = ARENA_ALIGN;
+    a->live += bytes;
+    if (a->live > a->peak) a->peak = a->live;
+    if (a->nOverflow == 0 && bytes <= a->capacity - a->used) {
+        void *p = a->base + a->used;
+        a->used += bytes;
+        memset(p, 0, bytes);
+        return p;
+    }
+
+    // Past the main block: a heap block of its own, until the arena is empty
+    // Au-del du bloc principal : un bloc du tas, jusqu' ce que l'arne soit vide
+    if (a->nOverflow == a->overflowCapacity) {
+        a->overflowCapacity = a->overflowCapacity ? 2 * a->overflowCapacity : 8;
+        a->overflow = xrealloc(a->overflow, a->overflowCapacity, sizeof(void *));
+        a->overflowSize = xrealloc(a->overflowSize, a->overflowCapacity, sizeof(size_t));
+    }
+    void *p = xcalloc(bytes, 1);
+    a->overflow[a->nOverflow] = p;
+    a->overflowSize[a->nOverflow++] = bytes;
+    return p;
+}
+
+void arenaRelease(ScratchArena *a, ArenaMark mark) {
+    while (a->nOverflow > mark.nOverflow) {
+        --a->nOverflow;
+        a->live -= a->overflowSize[a->nOverflow];
+        free(a->overflow[a->nOverflow]);
+    }
+    a->live -= a->used - mark.used;
+    a->used = mark.used;
+
+    // Empty again: grow the main block to the peak so the next round fits
+    // De nouveau vide : le bloc principal grandit jusqu'au pic pour la passe suivante
+    if (a->used == 0 && a->peak > a->capacity) {
+        free(a->base);
+        a->base = xcalloc(a->peak, 1);
+        a->capacity = a->peak;
+    }
+}
+
+void arenaFree(ScratchArena *a) {
+    for (uint32_t i = 0; i < a->nOverflow; ++i) free(a->overflow[i]);
+    free(a->base);
+    free(a->overflow);
+    free(a->overflowSize);
+    memset(a, 0, sizeof(*a));
+}
@@ -0,0 +1,149 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Range of batch indices owned by one worker, packed as (hi << 32 | lo) so
+// the owner (taking from lo) and thieves (taking the upper half) agree with
+// a single compare-and-swap.
+// Plage d'indices d'un travailleur, code (hi << 32 | lo) : le propritaire
+// (qui prend en bas) et les voleurs (qui prennent la moiti haute)
+// s'accordent par un seul compare-and-swap.
+typedef struct {
+    _Atomic uint64_t range;
+    char pad[64 - sizeof(uint64_t)];   // One deque per cache line / Une par ligne de cache
+} WorkDeque;
+
+typedef struct {
+    DfaMinimizer *const *dfas;
+    DfaBatchResult *results;
+    DfaEngine engine;
+    bool dropDead;
+    WorkDeque *deques;
+    int nWorkers;
+} BatchJob;
+
+typedef struct {
+    BatchJob *job;
+    int self;
+} BatchWorker;
+
+static inline uint64_t packRange(uint32_t lo, uint32_t hi) {
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Takes the next index from the worker's own range
+// Prend l'indice suivant dans la plage du travailleur
+static bool popOwn(WorkDeque *dq, uint32_t *index) {
+    uint64_t r = atomic_load(&dq->range);
+    for (;;) {
+        uint32_t lo = (uint32_t)r, hi = (uint32_t)(r >> 32);
+        if (lo >= hi) return false;
+        if (atomic_compare_exchange_weak(&dq->range, &r, packRange(lo + 1, hi))) {
+            *index = lo;
+            return true;
+        }
+    }
+}
+
+// Moves the upper half of a victim's range into the thief's (empty) range
+// Dplace la moiti haute de la plage d'une victime vers celle du voleur (vide)
+static bool steal(WorkDeque *victim, WorkDeque *thief) {
+    uint64_t r = atomic_load(&victim->range);
+    for (;;) {
+        uint32_t lo = (uint32_t)r, hi = (uint32_t)(r >> 32);
+        if (lo >= hi) return false;
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (atomic_compare_exchange_weak(&victim->range, &r, packRange(lo, mid))) {
+            atomic_store(&thief->range, packRange(mid, hi));
+            return true;
+        }
+    }
+}
+
+// Runs trim, initial partition and refinement on one DFA, lending it the
+// worker's scratch arena: the blocks grown for one DFA serve the next
+// Excute nettoyage, partition initiale et raffinement sur un automate, en
+// lui prtant l'arne du travailleur : les blocs agrandis pour un automate
+// servent au suivant
+static void minimizeOne(const BatchJob *job, uint32_t index, ScratchArena *scratch) {
+    DfaMinimizer *dfa = job->dfas[index];
+    DfaBatchResult *res = &job->results[index];
+    ScratchArena own = dfa->scratch;
+    dfa->scratch = *scratch;
+    res->status = dfaTrim(dfa, job->dropDead);
+    if (res->status == DFA_OK) res->status = dfaMinimize(dfa, job->engine);
+    res->partitionCount = res->status == DFA_OK ? dfaPartitionCount(dfa) : 0;
+    *scratch = dfa->scratch;
+    dfa->scratch = own;
+}
+
+static void *batchWorker(void *arg) {
+    BatchWorker *w = arg;
+    BatchJob *job = w->job;
+    WorkDeque *own = &job->deques[w->self];
+    ScratchArena scratch = { 0 };
+    uint32_t index;
+    for (;;) {
+        while (popOwn(own, &index)) minimizeOne(job, index, &scratch);
+
+        // Own range exhausted: steal from the others, starting with the next worker
+        // Plage puise : vole les autres, en commenant par le suivant
+        bool stolen = false;
+        for (int k = 1; k < job->nWorkers && !stolen; ++k) {
+            stolen = steal(&job->deques[(w->self + k) % job->nWorkers], own);
+        }
+        if (!stolen) {
+            arenaFree(&scratch);
+            return NULL;
+        }
+    }
+}
+
+DfaStatus dfaMinimizeBatch(DfaMinimizer *const *dfas, size_t count, DfaEngine engine,
+                           bool dropDead, int nThreads, DfaBatchResult *results) {
+    if ((count && (!dfas || !results)) || count >= UINT32_MAX) return DFA_ERR_INVALID;
+    if (nThreads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nThreads = online > 0 ? (int)online : 1;
+    }
+    if ((size_t)nThreads > count) nThreads = count ? (int)count : 1;
+
+    BatchJob job = { dfas, results, engine, dropDead, NULL, nThreads };
+    job.deques = aligned_alloc(64, sizeof(WorkDeque) * (size_t)nThreads);
+    BatchWorker *workers = malloc(sizeof(BatchWorker) * (size_t)nThreads);
+    pthread_t *threads = malloc(sizeof(pthread_t) * (size_t)nThreads);
+    if (!job.deques || !workers || !threads) {
+        perror("malloc for batch failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // Even initial split; stealing rebalances uneven DFA sizes
+    // Dcoupage initial gal ; le vol rquilibre les tailles ingales
+    for (int t = 0; t < nThreads; ++t) {
+        uint32_t lo = (uint32_t)(count * (size_t)t / (size_t)nThreads);
+        uint32_t hi = (uint32_t)(count * (size_t)(t + 1) / (size_t)nThreads);
+        atomic_init(&job.deques[t].range, packRange(lo, hi));
+        workers[t].job = &job;
+        workers[t].self = t;
+    }
+
+    // The calling thread acts as worker 0
+    // Le thread appelant sert de travailleur 0
+    int started = 1;
+    for (int t = 1; t < nThreads; ++t, ++started) {
+        if (pthread_create(&threads[t], NULL, batchWorker, &workers[t]) != 0) break;
+    }
+    batchWorker(&workers[0]);
+    for (int t = 1; t < started; ++t) pthread_join(threads[t], NULL);
+
+    free(threads);
+    free(workers);
+    free(job.deques);
+    return DFA_OK;
+}
@@ -0,0 +1,274 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DFA_BINARY_BYTE_ORDER 0x01020304u   // Reads differently on foreign hosts
+#define DFA_BINARY_NAMES      1u            // Flag: names section present
+#define DFA_BINARY_OUTPUTS    2u            // Flag: output classes present
+
+// On-disk header; every offset is from the start of the file and 8-aligned
+// En-tte sur disque ; chaque position part du dbut du fichier, aligne sur 8
+typedef struct {
+    char     magic[8];            // DFA_BINARY_MAGIC
+    uint32_t version;             // DFA_BINARY_VERSION
+    uint32_t byteOrder;           // DFA_BINARY_BYTE_ORDER as written
+    uint32_t flags;               // DFA_BINARY_NAMES | DFA_BINARY_OUTPUTS
+    uint32_t nStates;
+    uint32_t alphabetSize;
+    uint32_t nClasses;            // Table columns (alphabetSize if uncompressed)
+    uint32_t initialState;        // DFA_NO_STATE when nStates is 0
+    uint32_t nIntervals;          // Symbol intervals, 0 if uncompressed
+    uint64_t intervalsOffset;     // uint32_t[nIntervals] starts, then as many classes
+                                  // 8-aligned after them; 0 if uncompressed
+    uint64_t transitionsOffset;   // uint32_t[nStates * nClasses]
+    uint64_t finalOffset;         // uint64_t[(nStates + 63) / 64]
+    uint64_t namesOffset;         // char[nStates][4], 0 without names
+    uint64_t outputsOffset;       // int32_t[nStates], 0 without output classes
+    uint64_t fileSize;
+} DfaBinaryHeader;
+
+static inline uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~UINT64_C(7);
+}
+
+// Writes size bytes then zero padding up to the next 8-byte boundary
+// crit size octets puis des zros jusqu' la prochaine frontire de 8 octets
+static bool writeSection(FILE *out, const void *data, uint64_t size) {
+    static const char zeros[8];
+    if (size && fwrite(data, 1, size, out) != size) return false;
+    uint64_t pad = align8(size) - size;
+    return pad == 0 || fwrite(zeros, 1, pad, out) == pad;
+}
+
+DfaStatus dfaSaveBinary(const DfaMinimizer *d, FILE *out) {
+    if (!out) return DFA_ERR_INVALID;
+    bool hasNames = false;
+    for (uint32_t i = 0; i < d->nStates && !hasNames; ++i) hasNames = d->stateNames[i][0] != '\0';
+    bool hasOutputs = false;
+    for (uint32_t i = 0; d->outputs && i < d->nStates && !hasOutputs; ++i) hasOutputs = d->outputs[i] != 0;
+
+    uint64_t transitionsSize = (uint64_t)d->nStates * d->nClasses * sizeof(uint32_t);
+    uint64_t finalSize = (uint64_t)((d->nStates + 63) / 64) * sizeof(uint64_t);
+    DfaBinaryHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, DFA_BINARY_MAGIC, sizeof(h.magic));
+    h.version = DFA_BINARY_VERSION;
+    h.byteOrder = DFA_BINARY_BYTE_ORDER;
+    h.flags = (hasNames ? DFA_BINARY_NAMES : 0) | (hasOutputs ? DFA_BINARY_OUTPUTS : 0);
+    h.nStates = d->nStates;
+    h.alphabetSize = d->alphabetSize;
+    h.nClasses = d->nClasses;
+    h.initialState = d->nStates ? d->initialState : DFA_NO_STATE;
+    h.nIntervals = d->nIntervals;
+
+    uint64_t offset = align8(sizeof(h));
+    if (d->intervalClass) {
+        h.intervalsOffset = offset;
+        offset = align8(offset + (uint64_t)d->nIntervals * sizeof(uint32_t));
+        offset = align8(offset + (uint64_t)d->nIntervals * sizeof(uint32_t));
+    }
+    h.transitionsOffset = offset;
+    offset = align8(offset + transitionsSize);
+    h.finalOffset = offset;
+    offset = align8(offset + finalSize);
+    if (hasNames) {
+        h.namesOffset = offset;
+        offset = align8(offset + (uint64_t)d->nStates * sizeof(*d->stateNames));
+    }
+    if (hasOutputs) {
+        h.outputsOffset = offset;
+        offset = align8(offset + (uint64_t)d->nStates * sizeof(int32_t));
+    }
+    h.fileSize = offset;
+
+    bool ok = writeSection(out, &h, sizeof(h));
+    if (ok && d->intervalClass) {
+        uint64_t intervalsSize = (uint64_t)d->nIntervals * sizeof(uint32_t);
+        ok = writeSection(out, d->intervalStart, intervalsSize) && writeSection(out, d->intervalClass, intervalsSize);
+    }
+    if (ok) ok = writeSection(out, d->transitions, transitionsSize);
+    if (ok) ok = writeSection(out, d->finalBits, finalSize);
+    if (ok && hasNames) ok = writeSection(out, d->stateNames, (uint64_t)d->nStates * sizeof(*d->stateNames));
+    if (ok && hasOutputs) ok = writeSection(out, d->outputs, (uint64_t)d->nStates * sizeof(int32_t));
+    return ok && fflush(out) == 0 ? DFA_OK : DFA_ERR_IO;
+}
+
+// Offset of the interval classes, right after the 8-aligned interval starts
+// Position des classes d'intervalles, juste aprs les dbuts aligns sur 8
+static inline uint64_t classesOffset(const DfaBinaryHeader *h) {
+    return align8(h->intervalsOffset + (uint64_t)h->nIntervals * sizeof(uint32_t));
+}
+
+// Checks that a section [offset, offset + size) is aligned and inside the file
+// Vrifie qu'une section [offset, offset + size) est aligne et dans le fichier
+static bool sectionFits(const DfaBinaryHeader *h, uint64_t offset, uint64_t size) {
+    return offset % 8 == 0 && offset >= sizeof(*h) && offset <= h->fileSize &&
+           size <= h->fileSize - offset;
+}
+
+// Validates the header and every value the engines index with, in one
+// sequential pass, so that a corrupt file cannot cause out-of-bounds reads
+// Valide l'en-tte et chaque valeur servant d'indice aux moteurs, en un
+// parcours squentiel : un fichier corrompu ne peut pas provoquer de
+// lecture hors limites
+static bool validateBinary(const unsigned char *base, const DfaBinaryHeader *h) {
+    if (memcmp(h->magic, DFA_BINARY_MAGIC, sizeof(h->magic)) != 0 ||
+        h->version != DFA_BINARY_VERSION || h->byteOrder != DFA_BINARY_BYTE_ORDER) return false;
+    if (h->alphabetSize == 0 || h->alphabetSize > INT32_MAX || h->nClasses == 0 ||
+        h->nClasses > h->alphabetSize || (h->nClasses < h->alphabetSize && !h->intervalsOffset)) return false;
+    if (h->intervalsOffset ? h->nIntervals == 0 || h->nIntervals > h->alphabetSize : h->nIntervals != 0) return false;
+    if (h->nStates >= DFA_NO_STATE / 2) return false;
+    if (h->nStates ? h->initialState >= h->nStates : h->initialState != DFA_NO_STATE) return false;
+
+    uint64_t cells = (uint64_t)h->nStates * h->nClasses;
+    uint64_t words = (h->nStates + 63) / 64;
+    if (cells > SIZE_MAX / sizeof(uint32_t)) return false;
+    if (!sectionFits(h, h->transitionsOffset, cells * sizeof(uint32_t)) ||
+        !sectionFits(h, h->finalOffset, words * sizeof(uint64_t))) return false;
+    uint64_t intervalsSize = (uint64_t)h->nIntervals * sizeof(uint32_t);
+    if (h->intervalsOffset && (!sectionFits(h, h->intervalsOffset, intervalsSize) ||
+                               !sectionFits(h, classesOffset(h), intervalsSize))) return false;
+    if ((h->flags & DFA_BINARY_NAMES) ? !sectionFits(h, h->namesOffset, (uint64_t)h->nStates * 4)
+                                      : h->namesOffset != 0) return false;
+    if ((h->flags & DFA_BINARY_OUTPUTS) ? !sectionFits(h, h->outputsOffset, (uint64_t)h->nStates * sizeof(int32_t))
+                                        : h->outputsOffset != 0) return false;
+
+    const uint32_t *transitions = (const uint32_t *)(base + h->transitionsOffset);
+    for (uint64_t i = 0; i < cells; ++i) {
+        if (transitions[i] != DFA_NO_STATE && transitions[i] >= h->nStates) return false;
+    }
+    if (h->intervalsOffset) {
+        // Starts rise from 0 inside the alphabet
+        // Les dbuts croissent depuis 0 dans l'alphabet
+        const uint32_t *starts = (const uint32_t *)(base + h->intervalsOffset);
+        const uint32_t *classes = (const uint32_t *)(base + classesOffset(h));
+        if (starts[0] != 0) return false;
+        for (uint32_t i = 0; i < h->nIntervals; ++i) {
+            if ((i > 0 && starts[i] <= starts[i - 1]) || starts[i] >= h->alphabetSize) return false;
+            if (classes[i] >= h->nClasses) return false;
+        }
+    }
+
+    // Bits past the last state must be clear, as in a heap-built context
+    // Les bits aprs le dernier tat doivent tre nuls, comme sur le tas
+    const uint64_t *finalBits = (const uint64_t *)(base + h->finalOffset);
+    if ((h->nStates & 63) && (finalBits[words - 1] >> (h->nStates & 63)) != 0) return false;
+
+    if (h->flags & DFA_BINARY_NAMES) {
+        const char (*names)[4] = (const char (*)[4])(base + h->namesOffset);
+        for (uint32_t i = 0; i < h->nStates; ++i) {
+            if (!memchr(names[i], '\0', sizeof(names[i]))) return false;
+        }
+    }
+    return true;
+}
+
+DfaStatus dfaLoadBinary(const char *path, DfaMinimizer **out) {
+    if (!path || !out) return DFA_ERR_INVALID;
+    *out = NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return DFA_ERR_IO;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return DFA_ERR_IO;
+    }
+    if ((uint64_t)st.st_size < sizeof(DfaBinaryHeader)) {
+        close(fd);
+        return DFA_ERR_FORMAT;
+    }
+
+    // Private writable mapping: trimming may rewrite the table in place,
+    // and the kernel copies only the pages actually written
+    // Projection prive inscriptible : le nettoyage peut rcrire la table
+    // sur place, et le noyau ne copie que les pages rellement crites
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return DFA_ERR_IO;
+
+    const DfaBinaryHeader *h = map;
+    if (h->fileSize > size || !validateBinary(map, h)) {
+        munmap(map, size);
+        return DFA_ERR_FORMAT;
+    }
+
+    unsigned char *base = map;
+    DfaMinimizer *d = dfaCreate(h->alphabetSize);
+    d->mapping = map;
+    d->mappingSize = size;
+    d->nStates = d->statesCapacity = h->nStates;
+    d->nClasses = h->nClasses;
+    d->initialState = h->initialState;
+    if (h->nStates) {
+        // Empty sections may sit at the very end of the file: leave them NULL
+        // Les sections vides peuvent tre en toute fin de fichier : NULL
+        d->transitions = (uint32_t *)(base + h->transitionsOffset);
+        d->finalBits = (uint64_t *)(base + h->finalOffset);
+    }
+    if (h->intervalsOffset) {
+        d->nIntervals = h->nIntervals;
+        d->intervalStart = (uint32_t *)(base + h->intervalsOffset);
+        d->intervalClass = (uint32_t *)(base + classesOffset(h));
+    }
+    if (h->flags & DFA_BINARY_NAMES) d->stateNames = (char (*)[4])(base + h->namesOffset);
+    else d->stateNames = xcalloc(h->nStates, sizeof(*d->stateNames));
+    if ((h->flags & DFA_BINARY_OUTPUTS) && h->nStates) d->outputs = (int32_t *)(base + h->outputsOffset);
+    *out = d;
+    return DFA_OK;
+}
+
+// Whether p points into the context's file image
+// Indique si p pointe dans l'image du fichier du contexte
+static bool inMapping(const DfaMinimizer *d, const void *p) {
+    const unsigned char *base = d->mapping;
+    return p && (const unsigned char *)p >= base && (const unsigned char *)p < base + d->mappingSize;
+}
+
+// Heap copy of count elements of size bytes
+// Copie sur le tas de count lments de size octets
+static void *heapCopy(const void *src, size_t count, size_t size) {
+    void *p = xcalloc(count, size);
+    if (count) memcpy(p, src, count * size);
+    return p;
+}
+
+void dfaDetachMapping(DfaMinimizer *d) {
+    if (!d->mapping) return;
+    if (inMapping(d, d->transitions)) {
+        d->transitions = heapCopy(d->transitions, (size_t)d->statesCapacity * d->nClasses, sizeof(uint32_t));
+    }
+    if (inMapping(d, d->finalBits)) {
+        d->finalBits = heapCopy(d->finalBits, (d->statesCapacity + 63) / 64, sizeof(uint64_t));
+    }
+    if (inMapping(d, d->intervalStart)) {
+        d->intervalStart = heapCopy(d->intervalStart, d->nIntervals, sizeof(uint32_t));
+        d->intervalClass = heapCopy(d->intervalClass, d->nIntervals, sizeof(uint32_t));
+    }
+    if (inMapping(d, d->stateNames)) {
+        d->stateNames = heapCopy(d->stateNames, d->statesCapacity, sizeof(*d->stateNames));
+    }
+    if (inMapping(d, d->outputs)) {
+        d->outputs = heapCopy(d->outputs, d->statesCapacity, sizeof(int32_t));
+    }
+    dfaReleaseMapping(d);
+}
+
+void dfaReleaseMapping(DfaMinimizer *d) {
+    if (!d->mapping) return;
+    if (inMapping(d, d->transitions)) d->transitions = NULL;
+    if (inMapping(d, d->finalBits)) d->finalBits = NULL;
+    if (inMapping(d, d->intervalStart)) d->intervalStart = d->intervalClass = NULL;
+    if (inMapping(d, d->stateNames)) d->stateNames = NULL;
+    if (inMapping(d, d->outputs)) d->outputs = NULL;
+    munmap(d->mapping, d->mappingSize);
+    d->mapping = NULL;
+    d->mappingSize = 0;
+}
@@ -0,0 +1,352 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+// Orders edges by symbol, then source, then target
+// Ordonne les arcs par symbole, puis source, puis cible
+static int compareEdgesBySymbol(const void *x, const void *y) {
+    const NfaEdge *a = x, *b = y;
+    if (a->sym != b->sym) return a->sym < b->sym ? -1 : 1;
+    if (a->from != b->from) return a->from < b->from ? -1 : 1;
+    return a->to < b->to ? -1 : a->to > b->to;
+}
+
+// Orders edges by source, then symbol, then target
+// Ordonne les arcs par source, puis symbole, puis cible
+static int compareEdgesBySource(const void *x, const void *y) {
+    const NfaEdge *a = x, *b = y;
+    if (a->from != b->from) return a->from < b->from ? -1 : 1;
+    if (a->sym != b->sym) return a->sym < b->sym ? -1 : 1;
+    return a->to < b->to ? -1 : a->to > b->to;
+}
+
+// Paige-Tarjan state: the partition B of states and a coarser partition of
+// B into compound blocks, B being stable with respect to every compound for
+// every label. Each edge points to a counter holding the number of edges
+// with its source and label into the compound of its target, so that the
+// three-way split against a compound and a part of it costs only the edges
+// into that part.
+// tat de Paige-Tarjan : la partition B des tats et une partition plus
+// grossire de B en blocs composs, B tant stable vis--vis de chaque
+// compos pour chaque tiquette. Chaque arc pointe vers un compteur du
+// nombre d'arcs de mme source et de mme tiquette vers le compos de sa
+// cible : la division en trois contre un compos et une de ses parties ne
+// cote que les arcs entrant dans cette partie.
+typedef struct {
+    uint32_t  n;
+    size_t    m;
+    const NfaEdge *edges;        // Distinct edges, by label / Arcs distincts, par tiquette
+    uint32_t *label;             // Dense label of each edge / tiquette dense de chaque arc
+    uint32_t  nLabels;
+    size_t   *inStart;           // Edges into u: inEdges[inStart[u] .. inStart[u + 1])
+    uint32_t *inEdges;
+    RefinablePartition blocks;
+
+    uint32_t *compoundOf;        // Compound of each block / Compos de chaque bloc
+    uint32_t *nextBlock;         // Blocks of a compound as a doubly linked list
+    uint32_t *prevBlock;         // Blocs d'un compos en liste doublement chane
+    uint32_t *firstBlock;        // First block of each compound / Premier bloc de chaque compos
+    uint32_t *blockCount;        // Blocks per compound / Blocs par compos
+    uint32_t  nCompounds;
+    uint32_t *pending;           // Compounds of two blocks or more / Composs d'au moins deux blocs
+    uint32_t  nPending;
+
+    uint32_t *counterOf;         // Counter of each edge / Compteur de chaque arc
+    uint32_t *counts;
+    uint32_t  nCounters;
+    uint32_t  countersCapacity;
+    uint32_t *freeCounters;      // Counters back at zero / Compteurs revenus  zro
+    uint32_t  nFree;
+
+    uint32_t *stamp;             // Per state: last split seen / Par tat : dernire division vue
+    uint32_t  currentStamp;
+    uint32_t *oldCounter;        // Per state, valid under the current stamp
+    uint32_t *newCounter;        // Par tat, valides sous l'estampille courante
+} Bisimulation;
+
+// Adds block z to compound c, which becomes pending at its second block
+// Ajoute le bloc z au compos c, en attente ds son deuxime bloc
+static void compoundAdd(Bisimulation *x, uint32_t c, uint32_t z) {
+    x->compoundOf[z] = c;
+    x->prevBlock[z] = DFA_NO_STATE;
+    x->nextBlock[z] = x->firstBlock[c];
+    if (x->firstBlock[c] != DFA_NO_STATE) x->prevBlock[x->firstBlock[c]] = z;
+    x->firstBlock[c] = z;
+    if (++x->blockCount[c] == 2) x->pending[x->nPending++] = c;
+}
+
+// Removes block b from its compound
+// Retire le bloc b de son compos
+static void compoundRemove(Bisimulation *x, uint32_t b) {
+    uint32_t c = x->compoundOf[b];
+    if (x->prevBlock[b] != DFA_NO_STATE) x->nextBlock[x->prevBlock[b]] = x->nextBlock[b];
+    else x->firstBlock[c] = x->nextBlock[b];
+    if (x->nextBlock[b] != DFA_NO_STATE) x->prevBlock[x->nextBlock[b]] = x->prevBlock[b];
+    x->blockCount[c]--;
+}
+
+// Splits every block touched by marks; the new halves join the compound of
+// the block they come from
+// Divise chaque bloc touch par des marques ; les nouvelles moitis
+// rejoignent le compos du bloc dont elles viennent
+static void splitMarked(Bisimulation *x) {
+    RefinablePartition *p = &x->blocks;
+    uint32_t nTouched = p->nTouched;
+    p->nTouched = 0;
+    for (uint32_t i = 0; i < nTouched; ++i) {
+        uint32_t b = p->touched[i], z = p->nBlocks;
+        if (!refinableSplit(p, b, z)) continue;
+        p->nBlocks++;
+        compoundAdd(x, x->compoundOf[b], z);
+    }
+}
+
+static inline void markState(Bisimulation *x, uint32_t s) {
+    refinableMark(&x->blocks, s, x->blocks.touched, &x->blocks.nTouched);
+}
+
+// Starts a new stamp, clearing the stamps when it wraps around
+// Commence une nouvelle estampille, en effaant les estampilles au rebouclage
+static void nextStamp(Bisimulation *x) {
+    if (++x->currentStamp == 0) {
+        memset(x->stamp, 0, x->n * sizeof(uint32_t));
+        x->currentStamp = 1;
+    }
+}
+
+static uint32_t counterAlloc(Bisimulation *x) {
+    if (x->nFree > 0) return x->freeCounters[--x->nFree];
+    if (x->nCounters == x->countersCapacity) {
+        x->countersCapacity = x->countersCapacity ? x->countersCapacity * 2 : 64;
+        x->counts = xrealloc(x->counts, x->countersCapacity, sizeof(uint32_t));
+        x->freeCounters = xrealloc(x->freeCounters, x->countersCapacity, sizeof(uint32_t));
+    }
+    x->counts[x->nCounters] = 0;
+    return x->nCounters++;
+}
+
+// Makes B stable for the compound of all states: for each label, states
+// with an edge are split from those without, and the edges of a state on a
+// label share one counter
+// Rend B stable pour le compos de tous les tats : pour chaque tiquette,
+// les tats ayant un arc sont spars des autres, et les arcs d'un tat
+// pour une tiquette partagent un compteur
+static void initialSplits(Bisimulation *x) {
+    size_t e = 0;
+    while (e < x->m) {
+        size_t labelEnd = e;
+        while (labelEnd < x->m && x->label[labelEnd] == x->label[e]) labelEnd++;
+        for (size_t i = e; i < labelEnd; ++i) {
+            if (i == e || x->edges[i].from != x->edges[i - 1].from) {
+                markState(x, x->edges[i].from);
+                x->counterOf[i] = counterAlloc(x);
+            } else {
+                x->counterOf[i] = x->counterOf[i - 1];
+            }
+            x->counts[x->counterOf[i]]++;
+        }
+        splitMarked(x);
+        e = labelEnd;
+    }
+}
+
+// Takes the smaller of two blocks out of pending compound c as a compound of
+// its own, then splits B three ways for each label: sources with an edge
+// into it, and among them those with no edge left into the rest of c
+// Retire du compos en attente c le plus petit de deux de ses blocs, comme
+// compos  part, puis divise B en trois pour chaque tiquette : les sources
+// d'un arc vers lui, et parmi elles celles sans arc vers le reste de c
+static void splitCompound(Bisimulation *x, uint32_t c, uint32_t *buffer, uint32_t *labelCount,
+                          uint32_t *labels) {
+    RefinablePartition *p = &x->blocks;
+    uint32_t b1 = x->firstBlock[c], b2 = x->nextBlock[b1];
+    uint32_t splitter = p->end[b1] - p->first[b1] <= p->end[b2] - p->first[b2] ? b1 : b2;
+    compoundRemove(x, splitter);
+    if (x->blockCount[c] >= 2) x->pending[x->nPending++] = c;
+    uint32_t d = x->nCompounds++;
+    x->firstBlock[d] = DFA_NO_STATE;
+    x->blockCount[d] = 0;
+    compoundAdd(x, d, splitter);
+
+    // Edges into the splitter, grouped by label; the splitter may be split
+    // below, so its members are read first
+    // Arcs vers le sparateur, groups par tiquette ; le sparateur peut
+    // tre divis plus bas, ses membres sont donc lus d'abord
+    uint32_t nLabels = 0;
+    for (uint32_t i = p->first[splitter]; i < p->end[splitter]; ++i) {
+        uint32_t u = p->elems[i];
+        for (size_t j = x->inStart[u]; j < x->inStart[u + 1]; ++j) {
+            uint32_t a = x->label[x->inEdges[j]];
+            if (labelCount[a]++ == 0) labels[nLabels++] = a;
+        }
+    }
+    uint32_t offset = 0;
+    for (uint32_t l = 0; l < nLabels; ++l) {
+        uint32_t count = labelCount[labels[l]];
+        labelCount[labels[l]] = offset;
+        offset += count;
+    }
+    for (uint32_t i = p->first[splitter]; i < p->end[splitter]; ++i) {
+        uint32_t u = p->elems[i];
+        for (size_t j = x->inStart[u]; j < x->inStart[u + 1]; ++j) {
+            buffer[labelCount[x->label[x->inEdges[j]]]++] = x->inEdges[j];
+        }
+    }
+
+    uint32_t start = 0;
+    for (uint32_t l = 0; l < nLabels; ++l) {
+        uint32_t end = labelCount[labels[l]];
+        labelCount[labels[l]] = 0;
+
+        // Sources with an edge into the splitter
+        // Sources d'un arc vers le sparateur
+        for (uint32_t i = start; i < end; ++i) markState(x, x->edges[buffer[i]].from);
+        splitMarked(x);
+
+        // Their edges into the splitter move to fresh counters
+        // Leurs arcs vers le sparateur passent  de nouveaux compteurs
+        nextStamp(x);
+        for (uint32_t i = start; i < end; ++i) {
+            uint32_t e = buffer[i], s = x->edges[e].from;
+            if (x->stamp[s] != x->currentStamp) {
+                x->stamp[s] = x->currentStamp;
+                x->oldCounter[s] = x->counterOf[e];
+                x->newCounter[s] = counterAlloc(x);
+            }
+            x->counts[x->counterOf[e]]--;
+            x->counts[x->newCounter[s]]++;
+            x->counterOf[e] = x->newCounter[s];
+        }
+
+        // Those left without an edge into the rest of the compound
+        // Celles restes sans arc vers le reste du compos
+        nextStamp(x);
+        for (uint32_t i = start; i < end; ++i) {
+            uint32_t s = x->edges[buffer[i]].from;
+            if (x->stamp[s] == x->currentStamp) continue;
+            x->stamp[s] = x->currentStamp;
+            if (x->counts[x->oldCounter[s]] == 0) {
+                x->freeCounters[x->nFree++] = x->oldCounter[s];
+                markState(x, s);
+            }
+        }
+        splitMarked(x);
+        start = end;
+    }
+}
+
+DfaNfa *dfaNfaBisimulation(const DfaNfa *nfa) {
+    uint32_t n = nfa->nStates;
+    DfaNfa *out = dfaNfaCreate(nfa->alphabetSize);
+    if (n == 0) return out;
+
+    // Distinct edges sorted by label, labels renumbered densely
+    // Arcs distincts tris par tiquette, tiquettes renumrotes
+    NfaEdge *edges = xcalloc(nfa->nEdges, sizeof(NfaEdge));
+    if (nfa->nEdges) memcpy(edges, nfa->edges, nfa->nEdges * sizeof(NfaEdge));
+    qsort(edges, nfa->nEdges, sizeof(NfaEdge), compareEdgesBySymbol);
+    size_t m = 0;
+    for (size_t e = 0; e < nfa->nEdges; ++e) {
+        if (m == 0 || compareEdgesBySymbol(&edges[m - 1], &edges[e]) != 0) edges[m++] = edges[e];
+    }
+
+    Bisimulation x;
+    memset(&x, 0, sizeof(x));
+    x.n = n;
+    x.m = m;
+    x.edges = edges;
+    x.label = xcalloc(m, sizeof(uint32_t));
+    for (size_t e = 0; e < m; ++e) {
+        if (e > 0 && edges[e].sym != edges[e - 1].sym) x.nLabels++;
+        x.label[e] = x.nLabels;
+    }
+    if (m > 0) x.nLabels++;
+    x.inStart = xcalloc((size_t)n + 1, sizeof(size_t));
+    x.inEdges = xcalloc(m, sizeof(uint32_t));
+    for (size_t e = 0; e < m; ++e) x.inStart[edges[e].to + 1]++;
+    for (uint32_t u = 0; u < n; ++u) x.inStart[u + 1] += x.inStart[u];
+    size_t *cursor = xcalloc((size_t)n + 1, sizeof(size_t));
+    memcpy(cursor, x.inStart, ((size_t)n + 1) * sizeof(size_t));
+    for (size_t e = 0; e < m; ++e) x.inEdges[cursor[edges[e].to]++] = (uint32_t)e;
+    free(cursor);
+
+    // Final and non-final states, both in the compound of all states
+    // tats finaux et non finaux, tous deux dans le compos de tous les tats
+    uint32_t *blockOf = xcalloc(n, sizeof(uint32_t));
+    for (uint32_t s = 0; s < n; ++s) blockOf[s] = dfaNfaIsFinal(nfa, s) ? 0 : 1;
+    ScratchArena scratch = { 0 };
+    refinableInit(&x.blocks, n, blockOf, 2, &scratch);
+    arenaFree(&scratch);
+    x.compoundOf = xcalloc(n, sizeof(uint32_t));
+    x.nextBlock = xcalloc(n, sizeof(uint32_t));
+    x.prevBlock = xcalloc(n, sizeof(uint32_t));
+    x.firstBlock = xcalloc(n, sizeof(uint32_t));
+    x.blockCount = xcalloc(n, sizeof(uint32_t));
+    x.pending = xcalloc(n, sizeof(uint32_t));
+    x.firstBlock[0] = DFA_NO_STATE;
+    x.nCompounds = 1;
+    for (uint32_t b = 0; b < x.blocks.nBlocks; ++b) compoundAdd(&x, 0, b);
+    x.counterOf = xcalloc(m, sizeof(uint32_t));
+    x.stamp = xcalloc(n, sizeof(uint32_t));
+    x.oldCounter = xcalloc(n, sizeof(uint32_t));
+    x.newCounter = xcalloc(n, sizeof(uint32_t));
+    initialSplits(&x);
+
+    uint32_t *buffer = xcalloc(m, sizeof(uint32_t));
+    uint32_t *labelCount = xcalloc(x.nLabels, sizeof(uint32_t));
+    uint32_t *labels = xcalloc(x.nLabels, sizeof(uint32_t));
+    while (x.nPending > 0) splitCompound(&x, x.pending[--x.nPending], buffer, labelCount, labels);
+    free(labels);
+    free(labelCount);
+    free(buffer);
+
+    // Quotient: blocks numbered by first occurrence in state order, an
+    // edge per distinct (block, symbol, block)
+    // Quotient : blocs numrots par premire apparition dans l'ordre des
+    // tats, un arc par (bloc, symbole, bloc) distinct
+    memset(blockOf, 0xff, n * sizeof(uint32_t));
+    uint32_t *newId = blockOf;   // Old block id -> quotient state / Ancien bloc -> tat du quotient
+    uint32_t nBlocks = 0;
+    for (uint32_t s = 0; s < n; ++s) {
+        uint32_t b = x.blocks.sidx[s];
+        if (newId[b] == DFA_NO_STATE) newId[b] = nBlocks++;
+    }
+    dfaNfaAddStates(out, nBlocks);
+    for (uint32_t s = 0; s < n; ++s) {
+        uint32_t q = newId[x.blocks.sidx[s]];
+        if (dfaNfaIsInitial(nfa, s)) dfaNfaSetInitial(out, q, true);
+        if (dfaNfaIsFinal(nfa, s)) dfaNfaSetFinal(out, q, true);
+    }
+    for (size_t e = 0; e < m; ++e) {
+        edges[e].from = newId[x.blocks.sidx[edges[e].from]];
+        edges[e].to = newId[x.blocks.sidx[edges[e].to]];
+    }
+    qsort(edges, m, sizeof(NfaEdge), compareEdgesBySource);
+    for (size_t e = 0; e < m; ++e) {
+        if (e > 0 && compareEdgesBySource(&edges[e - 1], &edges[e]) == 0) continue;
+        dfaNfaAddTransition(out, edges[e].from, (int)edges[e].sym, edges[e].to);
+    }
+
+    free(x.newCounter);
+    free(x.oldCounter);
+    free(x.stamp);
+    free(x.freeCounters);
+    free(x.counts);
+    free(x.counterOf);
+    free(x.pending);
+    free(x.blockCount);
+    free(x.firstBlock);
+    free(x.prevBlock);
+    free(x.nextBlock);
+    free(x.compoundOf);
+    refinableFree(&x.blocks);
+    free(x.inEdges);
+    free(x.inStart);
+    free(x.label);
+    free(blockOf);
+    free(edges);
+    return out;
+}
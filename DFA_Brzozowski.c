@@ -0,0 +1,360 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+// Member entries allowed per edge of the DFA when dfaRefine() reverses it;
+// past that the subset construction is abandoned for Hopcroft
+// Entres de membres permises par arc de l'automate quand dfaRefine() le
+// renverse ; au-del la construction des sous-ensembles cde  Hopcroft
+#define BRZOZOWSKI_MEMBER_BUDGET 32
+
+// Deterministic automaton whose states are subsets of the states of another
+// automaton. Each subset is stored once, members sorted, in a shared pool,
+// and found again through an open-addressing table of its hash.
+// Automate dterministe dont les tats sont des sous-ensembles des tats
+// d'un autre automate. Chaque sous-ensemble est stock une fois, membres
+// tris, dans un rservoir commun, et retrouv par une table  adressage
+// ouvert de son hachage.
+typedef struct {
+    uint32_t  k;
+    uint32_t  nStates;
+    uint32_t  capacity;
+    uint32_t *transitions;      // nStates * k, DFA_NO_STATE for the empty subset
+    uint64_t *finalBits;
+    size_t   *memberStart;      // Subset i is members[memberStart[i] .. memberStart[i + 1])
+    uint32_t *members;
+    size_t    membersCapacity;
+    size_t    memberLimit;      // 0 for no limit
+    bool      overflow;         // memberLimit was reached
+    uint32_t *table;            // Subset ids, DFA_NO_STATE when empty
+    uint32_t  tableMask;
+} SubsetDfa;
+
+static uint64_t subsetHash(const uint32_t *m, uint32_t count) {
+    uint64_t h = UINT64_C(0xcbf29ce484222325) ^ count;
+    for (uint32_t i = 0; i < count; ++i) h = (h ^ m[i]) * UINT64_C(0x100000001b3);
+    return h ^ (h >> 29);
+}
+
+static void subsetInit(SubsetDfa *sd, uint32_t k, size_t memberLimit) {
+    memset(sd, 0, sizeof(*sd));
+    sd->k = k;
+    sd->memberLimit = memberLimit;
+    sd->capacity = 64;
+    sd->transitions = xcalloc((size_t)sd->capacity * k, sizeof(uint32_t));
+    sd->finalBits = xcalloc(sd->capacity / 64, sizeof(uint64_t));
+    sd->memberStart = xcalloc((size_t)sd->capacity + 1, sizeof(size_t));
+    sd->membersCapacity = 256;
+    sd->members = xcalloc(sd->membersCapacity, sizeof(uint32_t));
+    sd->tableMask = 127;
+    sd->table = xcalloc((size_t)sd->tableMask + 1, sizeof(uint32_t));
+    memset(sd->table, 0xff, ((size_t)sd->tableMask + 1) * sizeof(uint32_t));
+}
+
+static void subsetFree(SubsetDfa *sd) {
+    free(sd->transitions); free(sd->finalBits);
+    free(sd->memberStart); free(sd->members); free(sd->table);
+}
+
+// Doubles the hash table and reinserts every subset
+// Double la table de hachage et y rinsre chaque sous-ensemble
+static void subsetRehash(SubsetDfa *sd) {
+    free(sd->table);
+    sd->tableMask = sd->tableMask * 2 + 1;
+    sd->table = xcalloc((size_t)sd->tableMask + 1, sizeof(uint32_t));
+    memset(sd->table, 0xff, ((size_t)sd->tableMask + 1) * sizeof(uint32_t));
+    for (uint32_t id = 0; id < sd->nStates; ++id) {
+        const uint32_t *m = sd->members + sd->memberStart[id];
+        uint32_t count = (uint32_t)(sd->memberStart[id + 1] - sd->memberStart[id]);
+        uint32_t slot = (uint32_t)subsetHash(m, count) & sd->tableMask;
+        while (sd->table[slot] != DFA_NO_STATE) slot = (slot + 1) & sd->tableMask;
+        sd->table[slot] = id;
+    }
+}
+
+// Id of the sorted subset m, added as a new state when first seen
+// Numro du sous-ensemble tri m, ajout comme nouvel tat  sa dcouverte
+static uint32_t internSubset(SubsetDfa *sd, const uint32_t *m, uint32_t count) {
+    uint32_t slot = (uint32_t)subsetHash(m, count) & sd->tableMask;
+    uint32_t id;
+    while ((id = sd->table[slot]) != DFA_NO_STATE) {
+        size_t start = sd->memberStart[id];
+        if (sd->memberStart[id + 1] - start == count && memcmp(sd->members + start, m, count * sizeof(uint32_t)) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & sd->tableMask;
+    }
+    if (sd->memberLimit && sd->memberStart[sd->nStates] + count > sd->memberLimit) {
+        sd->overflow = true;
+        return DFA_NO_STATE;
+    }
+    if (sd->nStates == DFA_NO_STATE - 1) {
+        fputs("subset construction: too many states\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    id = sd->nStates++;
+    if (id == sd->capacity) {
+        uint32_t capacity = sd->capacity > DFA_NO_STATE / 2 ? DFA_NO_STATE : sd->capacity * 2;
+        sd->transitions = xrealloc(sd->transitions, (size_t)capacity * sd->k, sizeof(uint32_t));
+        sd->finalBits = xrealloc(sd->finalBits, (capacity + 63) / 64, sizeof(uint64_t));
+        memset(sd->finalBits + sd->capacity / 64, 0, ((capacity + 63) / 64 - sd->capacity / 64) * sizeof(uint64_t));
+        sd->memberStart = xrealloc(sd->memberStart, (size_t)capacity + 1, sizeof(size_t));
+        sd->capacity = capacity;
+    }
+    size_t start = sd->memberStart[id];
+    if (start + count > sd->membersCapacity) {
+        while (start + count > sd->membersCapacity) sd->membersCapacity *= 2;
+        sd->members = xrealloc(sd->members, sd->membersCapacity, sizeof(uint32_t));
+    }
+    memcpy(sd->members + start, m, count * sizeof(uint32_t));
+    sd->memberStart[id + 1] = start + count;
+    sd->table[slot] = id;
+    if (2 * (uint64_t)sd->nStates > sd->tableMask) subsetRehash(sd);
+    return id;
+}
+
+static int compareStates(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Predecessor lists of an automaton given by its edges: the sources of the
+// edges into q on c are preds[predStart[q * k + c] .. predStart[q * k + c + 1])
+// Listes de prdcesseurs d'un automate donn par ses arcs : les sources des
+// arcs vers q par c sont preds[predStart[q * k + c] .. predStart[q * k + c + 1])
+static void predecessorIndex(uint32_t n, uint32_t k, const NfaEdge *edges, size_t nEdges,
+                             ScratchArena *scratch, size_t **predStart, uint32_t **preds) {
+    size_t slots = (size_t)n * k;
+    size_t *start = arenaAlloc(scratch, slots + 1, sizeof(size_t));
+    uint32_t *list = arenaAlloc(scratch, nEdges, sizeof(uint32_t));
+    for (size_t e = 0; e < nEdges; ++e) start[(size_t)edges[e].to * k + edges[e].sym + 1]++;
+    for (size_t i = 0; i < slots; ++i) start[i + 1] += start[i];
+    for (size_t e = 0; e < nEdges; ++e) list[start[(size_t)edges[e].to * k + edges[e].sym]++] = edges[e].from;
+    memmove(start + 1, start, slots * sizeof(size_t));
+    start[0] = 0;
+    *predStart = start;
+    *preds = list;
+}
+
+// Subset construction on the reverse of an automaton with n states and k
+// columns, given by its predecessor lists: it starts from the sorted subset
+// start, and subset S moves on c to the predecessors of S on c. Subsets
+// meeting acceptBits (may be NULL) are final. Returns false, with a partial
+// result, when the subsets outgrow memberLimit.
+// Construction des sous-ensembles sur l'inverse d'un automate  n tats et
+// k colonnes, donn par ses listes de prdcesseurs : elle part du
+// sous-ensemble tri start, et S mne par c aux prdcesseurs de S par c.
+// Les sous-ensembles qui rencontrent acceptBits (peut tre NULL) sont finaux.
+// Renvoie false, avec un rsultat partiel, si les sous-ensembles dpassent
+// memberLimit.
+static bool reverseDeterminize(SubsetDfa *sd, uint32_t n, uint32_t k, const size_t *predStart,
+                               const uint32_t *preds, const uint32_t *start, uint32_t nStart,
+                               const uint64_t *acceptBits, size_t memberLimit, ScratchArena *scratch) {
+    subsetInit(sd, k, memberLimit);
+    if (nStart == 0) return true;
+    if (internSubset(sd, start, nStart) == DFA_NO_STATE) return false;
+
+    // seen[p] == stamp marks p as already collected for the current move
+    // seen[p] == stamp indique que p est dj collect pour ce dplacement
+    ArenaMark mark = arenaMark(scratch);
+    uint32_t *buffer = arenaAlloc(scratch, n, sizeof(uint32_t));
+    uint32_t *seen = arenaAlloc(scratch, n, sizeof(uint32_t));
+    uint32_t stamp = 0;
+    for (uint32_t i = 0; i < sd->nStates && !sd->overflow; ++i) {
+        for (uint32_t c = 0; c < k && !sd->overflow; ++c) {
+            if (++stamp == 0) {
+                memset(seen, 0, n * sizeof(uint32_t));
+                stamp = 1;
+            }
+            uint32_t count = 0;
+            for (size_t j = sd->memberStart[i]; j < sd->memberStart[i + 1]; ++j) {
+                size_t slot = (size_t)sd->members[j] * k + c;
+                for (size_t e = predStart[slot]; e < predStart[slot + 1]; ++e) {
+                    uint32_t p = preds[e];
+                    if (seen[p] == stamp) continue;
+                    seen[p] = stamp;
+                    buffer[count++] = p;
+                }
+            }
+            uint32_t target = DFA_NO_STATE;
+            if (count > 0) {
+                qsort(buffer, count, sizeof(uint32_t), compareStates);
+                target = internSubset(sd, buffer, count);
+            }
+            sd->transitions[(size_t)i * k + c] = target;
+        }
+    }
+    arenaRelease(scratch, mark);
+
+    if (sd->overflow) return false;
+    if (!acceptBits) return true;
+    for (uint32_t i = 0; i < sd->nStates; ++i) {
+        for (size_t j = sd->memberStart[i]; j < sd->memberStart[i + 1]; ++j) {
+            uint32_t q = sd->members[j];
+            if ((acceptBits[q >> 6] >> (q & 63)) & 1) {
+                sd->finalBits[i >> 6] |= UINT64_C(1) << (i & 63);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+uint32_t dfaBrzozowskiBlocks(DfaMinimizer *d, uint32_t *blockOf) {
+    uint32_t n = d->nStates, k = d->nClasses;
+    if (n == 0) return 0;
+
+    // Column k leads each state s to an extra state h(g) = n + g, where g is
+    // its group of finality and output class, and column k + 1 leads h(g)
+    // to h(g - 1): s then accepts w k (k + 1)^g from h(0) for every word w
+    // reaching a state of group g. No state shares its language with the
+    // virtual sink, as in the other engines. Work arrays come from the
+    // DFA's arena; only the growing subset automaton is on the heap.
+    // La colonne k mne chaque tat s  un tat supplmentaire h(g) = n + g,
+    // o g est son groupe de finalit et de classe de sortie, et la colonne
+    // k + 1 mne h(g)  h(g - 1) : s accepte alors depuis h(0) le mot
+    // w k (k + 1)^g pour chaque mot w menant  un tat du groupe g. Aucun
+    // tat ne partage son langage avec le puits virtuel, comme dans les
+    // autres moteurs. Les tableaux de travail viennent de l'arne de
+    // l'automate ; seul l'automate des sous-ensembles, qui grandit, est
+    // pris sur le tas.
+    ScratchArena *scratch = &d->scratch;
+    ArenaMark mark = arenaMark(scratch);
+    uint32_t *group = arenaAlloc(scratch, n, sizeof(uint32_t));
+    uint32_t nGroups = dfaOutputBlocks(d, NULL, n, group, scratch);
+    NfaEdge *edges = arenaAlloc(scratch, (size_t)n * (k + 1) + nGroups, sizeof(NfaEdge));
+    size_t nEdges = 0;
+    for (uint32_t s = 0; s < n; ++s) {
+        for (uint32_t c = 0; c < k; ++c) {
+            uint32_t t = d->transitions[(size_t)s * k + c];
+            if (t != DFA_NO_STATE) edges[nEdges++] = (NfaEdge){ s, c, t };
+        }
+        edges[nEdges++] = (NfaEdge){ s, k, n + group[s] };
+    }
+    for (uint32_t g = 1; g < nGroups; ++g) edges[nEdges++] = (NfaEdge){ n + g, k + 1, n + g - 1 };
+    size_t *predStart;
+    uint32_t *preds;
+    predecessorIndex(n + nGroups, k + 2, edges, nEdges, scratch, &predStart, &preds);
+
+    uint32_t start[1] = { n };
+    SubsetDfa sd;
+    bool complete = reverseDeterminize(&sd, n + nGroups, k + 2, predStart, preds, start, 1, NULL,
+                                       BRZOZOWSKI_MEMBER_BUDGET * (nEdges + 1), scratch);
+    if (!complete) {
+        subsetFree(&sd);
+        arenaRelease(scratch, mark);
+        return 0;
+    }
+
+    // Reversing again: the state of the second determinization reached
+    // with s is the set of subsets containing s, so states with equal sets
+    // are equivalent. Lists come out sorted since subsets are read in order.
+    // Second renversement : l'tat de la seconde dterminisation atteint
+    // avec s est l'ensemble des sous-ensembles contenant s ; les tats aux
+    // ensembles gaux sont quivalents. Les listes sortent tries car les
+    // sous-ensembles sont lus dans l'ordre.
+    size_t *listStart = arenaAlloc(scratch, (size_t)n + 2, sizeof(size_t));
+    for (size_t j = 0; j < sd.memberStart[sd.nStates]; ++j) {
+        if (sd.members[j] < n) listStart[sd.members[j] + 2]++;
+    }
+    for (uint32_t s = 0; s < n; ++s) listStart[s + 2] += listStart[s + 1];
+    uint32_t *lists = arenaAlloc(scratch, listStart[n + 1], sizeof(uint32_t));
+    for (uint32_t id = 0; id < sd.nStates; ++id) {
+        for (size_t j = sd.memberStart[id]; j < sd.memberStart[id + 1]; ++j) {
+            if (sd.members[j] < n) lists[listStart[sd.members[j] + 1]++] = id;
+        }
+    }
+    subsetFree(&sd);
+
+    uint32_t tableSize = 1;
+    while (tableSize < 2 * (uint64_t)n) tableSize *= 2;
+    uint32_t *table = arenaAlloc(scratch, tableSize, sizeof(uint32_t));   // Block -> first state
+    memset(table, 0xff, tableSize * sizeof(uint32_t));
+    uint32_t *reps = arenaAlloc(scratch, n, sizeof(uint32_t));
+    uint32_t nBlocks = 0;
+    for (uint32_t s = 0; s < n; ++s) {
+        const uint32_t *list = lists + listStart[s];
+        uint32_t count = (uint32_t)(listStart[s + 1] - listStart[s]);
+        uint32_t slot = (uint32_t)subsetHash(list, count) & (tableSize - 1);
+        uint32_t b;
+        while ((b = table[slot]) != DFA_NO_STATE) {
+            uint32_t r = reps[b];
+            if (listStart[r + 1] - listStart[r] == count &&
+                memcmp(lists + listStart[r], list, count * sizeof(uint32_t)) == 0) break;
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (b == DFA_NO_STATE) {
+            b = table[slot] = nBlocks;
+            reps[nBlocks++] = s;
+        }
+        blockOf[s] = b;
+    }
+    arenaRelease(scratch, mark);
+    return nBlocks;
+}
+
+DfaMinimizer *dfaBrzozowski(const DfaNfa *nfa) {
+    uint32_t n = nfa->nStates, k = nfa->alphabetSize;
+
+    // First pass: determinize the reverse of the NFA
+    // Premire passe : dterminise l'inverse de l'automate
+    ScratchArena scratch = { 0 };
+    ArenaMark mark = arenaMark(&scratch);
+    size_t *predStart;
+    uint32_t *preds;
+    predecessorIndex(n, k, nfa->edges, nfa->nEdges, &scratch, &predStart, &preds);
+    uint32_t *start = xcalloc(n, sizeof(uint32_t));
+    uint32_t nStart = 0;
+    for (uint32_t s = 0; s < n; ++s) {
+        if (dfaNfaIsFinal(nfa, s)) start[nStart++] = s;
+    }
+    SubsetDfa reversed;
+    reverseDeterminize(&reversed, n, k, predStart, preds, start, nStart, nfa->initialBits, 0, &scratch);
+    free(start);
+    arenaRelease(&scratch, mark);
+
+    // Second pass: determinize the reverse of the first result, which is
+    // accessible and deterministic, hence the result is minimal
+    // Seconde passe : dterminise l'inverse du premier rsultat, accessible
+    // et dterministe, si bien que le rsultat est minimal
+    uint32_t m = reversed.nStates;
+    NfaEdge *edges = xcalloc((size_t)m * k, sizeof(NfaEdge));
+    size_t nEdges = 0;
+    for (uint32_t s = 0; s < m; ++s) {
+        for (uint32_t c = 0; c < k; ++c) {
+            uint32_t t = reversed.transitions[(size_t)s * k + c];
+            if (t != DFA_NO_STATE) edges[nEdges++] = (NfaEdge){ s, c, t };
+        }
+    }
+    predecessorIndex(m, k, edges, nEdges, &scratch, &predStart, &preds);
+    free(edges);
+    start = xcalloc(m, sizeof(uint32_t));
+    nStart = 0;
+    for (uint32_t s = 0; s < m; ++s) {
+        if ((reversed.finalBits[s >> 6] >> (s & 63)) & 1) start[nStart++] = s;
+    }
+    uint64_t *initialBits = xcalloc((size_t)m / 64 + 1, sizeof(uint64_t));
+    initialBits[0] = 1;   // The first pass starts from its subset 0 / La premire passe part de son sous-ensemble 0
+    SubsetDfa minimal;
+    reverseDeterminize(&minimal, m, k, predStart, preds, start, nStart, initialBits, 0, &scratch);
+    free(initialBits);
+    free(start);
+    arenaFree(&scratch);
+    subsetFree(&reversed);
+
+    // The empty language keeps one non-final state
+    // Le langage vide garde un tat non final
+    DfaMinimizer *d = dfaCreate(k);
+    dfaAddStates(d, minimal.nStates ? minimal.nStates : 1);
+    for (uint32_t i = 0; i < minimal.nStates; ++i) {
+        memcpy(&d->transitions[(size_t)i * k], &minimal.transitions[(size_t)i * k], k * sizeof(uint32_t));
+        setFinalState(d, i, (minimal.finalBits[i >> 6] >> (i & 63)) & 1);
+    }
+    d->initialState = 0;
+    subsetFree(&minimal);
+    return d;
+}
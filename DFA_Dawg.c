@@ -0,0 +1,235 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+// States live in slots of a dense table; the slot of a state found equal
+// to a registered one is recycled. path[i] is the state reached by the
+// first i symbols of the last word: those states are the only ones still
+// open to change, all others being in the register.
+// Les tats occupent les cases d'une table dense ; la case d'un tat gal
+//  un tat du registre est recycle. path[i] est l'tat atteint par les i
+// premiers symboles du dernier mot : seuls ces tats peuvent encore
+// changer, tous les autres sont dans le registre.
+struct DfaDawgBuilder {
+    uint32_t  k;
+    uint32_t  nSlots;           // Slots handed out, recycled ones included
+    uint32_t  capacity;
+    uint32_t *transitions;      // nSlots * k
+    uint64_t *finalBits;
+    uint32_t *freeSlots;        // Recycled slots, capacity entries
+    uint32_t  nFree;
+
+    uint32_t *table;            // Register: state ids, DFA_NO_STATE when empty
+    uint32_t  tableMask;
+    uint32_t  nRegistered;
+
+    int      *lastWord;
+    uint32_t *path;             // lastLength + 1 states
+    size_t    lastLength;
+    size_t    pathCapacity;
+    size_t    nWords;
+    bool      finished;
+};
+
+static inline bool slotIsFinal(const DfaDawgBuilder *b, uint32_t s) {
+    return (b->finalBits[s >> 6] >> (s & 63)) & 1;
+}
+
+// Takes a recycled slot, or a new one, as a state without transitions
+// Prend une case recycle, ou une nouvelle, comme tat sans transition
+static uint32_t newSlot(DfaDawgBuilder *b) {
+    uint32_t s;
+    if (b->nFree > 0) {
+        s = b->freeSlots[--b->nFree];
+    } else {
+        if (b->nSlots == DFA_NO_STATE - 1) {
+            fputs("DAWG builder: too many states\n", stderr);
+            exit(EXIT_FAILURE);
+        }
+        if (b->nSlots == b->capacity) {
+            uint32_t capacity = b->capacity > DFA_NO_STATE / 2 ? DFA_NO_STATE - 1 : b->capacity * 2;
+            b->transitions = xrealloc(b->transitions, (size_t)capacity * b->k, sizeof(uint32_t));
+            b->finalBits = xrealloc(b->finalBits, (capacity + 63) / 64, sizeof(uint64_t));
+            b->freeSlots = xrealloc(b->freeSlots, capacity, sizeof(uint32_t));
+            b->capacity = capacity;
+        }
+        s = b->nSlots++;
+    }
+    for (uint32_t c = 0; c < b->k; ++c) b->transitions[(size_t)s * b->k + c] = DFA_NO_STATE;
+    b->finalBits[s >> 6] &= ~(UINT64_C(1) << (s & 63));
+    return s;
+}
+
+// Hash of a state: its finality and its row of targets
+// Hachage d'un tat : sa finalit et sa ligne de cibles
+static uint64_t stateHash(const DfaDawgBuilder *b, uint32_t s) {
+    const uint32_t *row = &b->transitions[(size_t)s * b->k];
+    uint64_t h = UINT64_C(0xcbf29ce484222325) ^ slotIsFinal(b, s);
+    for (uint32_t c = 0; c < b->k; ++c) h = (h ^ row[c]) * UINT64_C(0x100000001b3);
+    return h ^ (h >> 29);
+}
+
+static bool sameState(const DfaDawgBuilder *b, uint32_t s, uint32_t t) {
+    return slotIsFinal(b, s) == slotIsFinal(b, t) &&
+           memcmp(&b->transitions[(size_t)s * b->k], &b->transitions[(size_t)t * b->k], b->k * sizeof(uint32_t)) == 0;
+}
+
+// Doubles the register and reinserts every state
+// Double le registre et y rinsre chaque tat
+static void growRegister(DfaDawgBuilder *b) {
+    uint32_t *old = b->table;
+    uint32_t oldSize = b->tableMask + 1;
+    b->tableMask = b->tableMask * 2 + 1;
+    b->table = xcalloc((size_t)b->tableMask + 1, sizeof(uint32_t));
+    memset(b->table, 0xff, ((size_t)b->tableMask + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < oldSize; ++i) {
+        if (old[i] == DFA_NO_STATE) continue;
+        uint32_t slot = (uint32_t)stateHash(b, old[i]) & b->tableMask;
+        while (b->table[slot] != DFA_NO_STATE) slot = (slot + 1) & b->tableMask;
+        b->table[slot] = old[i];
+    }
+    free(old);
+}
+
+// Registered state equal to s, s itself being registered if there is none
+// tat du registre gal  s, s tant lui-mme enregistr s'il n'y en a pas
+static uint32_t registerState(DfaDawgBuilder *b, uint32_t s) {
+    uint32_t slot = (uint32_t)stateHash(b, s) & b->tableMask;
+    uint32_t t;
+    while ((t = b->table[slot]) != DFA_NO_STATE) {
+        if (sameState(b, s, t)) return t;
+        slot = (slot + 1) & b->tableMask;
+    }
+    b->table[slot] = s;
+    if (2 * (uint64_t)++b->nRegistered > b->tableMask) growRegister(b);
+    return s;
+}
+
+// Closes the states of the last word's path deeper than depth, deepest
+// first: each is replaced by its registered twin, or registered itself
+// Ferme les tats du chemin du dernier mot plus profonds que depth, du
+// plus profond au moins profond : chacun est remplac par son jumeau du
+// registre, ou enregistr lui-mme
+static void replaceOrRegister(DfaDawgBuilder *b, size_t depth) {
+    for (size_t i = b->lastLength; i > depth; --i) {
+        uint32_t child = b->path[i];
+        uint32_t twin = registerState(b, child);
+        if (twin == child) continue;
+        b->transitions[(size_t)b->path[i - 1] * b->k + (uint32_t)b->lastWord[i - 1]] = twin;
+        b->freeSlots[b->nFree++] = child;
+    }
+    b->lastLength = depth;
+}
+
+DfaDawgBuilder *dfaDawgCreate(uint32_t alphabetSize) {
+    if (alphabetSize == 0 || alphabetSize > INT32_MAX) return NULL;
+    DfaDawgBuilder *b = xcalloc(1, sizeof(DfaDawgBuilder));
+    b->k = alphabetSize;
+    b->capacity = 64;
+    b->transitions = xcalloc((size_t)b->capacity * alphabetSize, sizeof(uint32_t));
+    b->finalBits = xcalloc(b->capacity / 64, sizeof(uint64_t));
+    b->freeSlots = xcalloc(b->capacity, sizeof(uint32_t));
+    b->tableMask = 255;
+    b->table = xcalloc((size_t)b->tableMask + 1, sizeof(uint32_t));
+    memset(b->table, 0xff, ((size_t)b->tableMask + 1) * sizeof(uint32_t));
+    b->pathCapacity = 64;
+    b->lastWord = xcalloc(b->pathCapacity, sizeof(int));
+    b->path = xcalloc(b->pathCapacity + 1, sizeof(uint32_t));
+    b->path[0] = newSlot(b);
+    return b;
+}
+
+void dfaDawgDestroy(DfaDawgBuilder *b) {
+    if (!b) return;
+    free(b->transitions);
+    free(b->finalBits);
+    free(b->freeSlots);
+    free(b->table);
+    free(b->lastWord);
+    free(b->path);
+    free(b);
+}
+
+DfaStatus dfaDawgAddWord(DfaDawgBuilder *b, const int *word, size_t length) {
+    if (b->finished || (length > 0 && !word)) return DFA_ERR_INVALID;
+    for (size_t i = 0; i < length; ++i) {
+        if (word[i] < 0 || (uint32_t)word[i] >= b->k) return DFA_ERR_INVALID;
+    }
+
+    // Common prefix with the last word, which must not come after this one
+    // Prfixe commun avec le dernier mot, qui ne doit pas suivre celui-ci
+    size_t prefix = 0;
+    if (b->nWords > 0) {
+        while (prefix < length && prefix < b->lastLength && word[prefix] == b->lastWord[prefix]) ++prefix;
+        if (prefix == length && prefix == b->lastLength) return DFA_OK;
+        if (prefix == length || (prefix < b->lastLength && word[prefix] < b->lastWord[prefix])) {
+            return DFA_ERR_INVALID;
+        }
+    }
+    replaceOrRegister(b, prefix);
+
+    if (length > b->pathCapacity) {
+        while (length > b->pathCapacity) b->pathCapacity *= 2;
+        b->lastWord = xrealloc(b->lastWord, b->pathCapacity, sizeof(int));
+        b->path = xrealloc(b->path, b->pathCapacity + 1, sizeof(uint32_t));
+    }
+
+    // The suffix gets fresh states, open until a later word diverges
+    // Le suffixe reoit des tats neufs, ouverts jusqu' ce qu'un mot diverge
+    for (size_t i = prefix; i < length; ++i) {
+        uint32_t s = newSlot(b);
+        b->transitions[(size_t)b->path[i] * b->k + (uint32_t)word[i]] = s;
+        b->path[i + 1] = s;
+        b->lastWord[i] = word[i];
+    }
+    b->finalBits[b->path[length] >> 6] |= UINT64_C(1) << (b->path[length] & 63);
+    b->lastLength = length;
+    b->nWords++;
+    return DFA_OK;
+}
+
+size_t dfaDawgWordCount(const DfaDawgBuilder *b) {
+    return b->nWords;
+}
+
+DfaMinimizer *dfaDawgFinish(DfaDawgBuilder *b) {
+    if (!b->finished) {
+        replaceOrRegister(b, 0);
+        b->finished = true;
+    }
+
+    // Breadth-first numbering from the root skips the recycled slots
+    // La numrotation en largeur depuis la racine saute les cases recycles
+    uint32_t k = b->k;
+    uint32_t *newId = xcalloc(b->nSlots, sizeof(uint32_t));
+    uint32_t *queue = xcalloc(b->nSlots, sizeof(uint32_t));
+    memset(newId, 0xff, b->nSlots * sizeof(uint32_t));
+    uint32_t head = 0, tail = 0;
+    newId[b->path[0]] = tail;
+    queue[tail++] = b->path[0];
+    while (head < tail) {
+        const uint32_t *row = &b->transitions[(size_t)queue[head++] * k];
+        for (uint32_t c = 0; c < k; ++c) {
+            if (row[c] != DFA_NO_STATE && newId[row[c]] == DFA_NO_STATE) {
+                newId[row[c]] = tail;
+                queue[tail++] = row[c];
+            }
+        }
+    }
+
+    DfaMinimizer *d = dfaCreate(k);
+    dfaAddStates(d, tail);
+    for (uint32_t i = 0; i < tail; ++i) {
+        const uint32_t *row = &b->transitions[(size_t)queue[i] * k];
+        uint32_t *dst = &d->transitions[(size_t)i * k];
+        for (uint32_t c = 0; c < k; ++c) dst[c] = row[c] == DFA_NO_STATE ? DFA_NO_STATE : newId[row[c]];
+        setFinalState(d, i, slotIsFinal(b, queue[i]));
+    }
+    d->initialState = 0;
+    free(queue);
+    free(newId);
+    return d;
+}
@@ -0,0 +1,315 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+// Open-addressing map from pairs of ids to ids, growing past half load
+// Table  adressage ouvert des couples de numros vers des numros,
+// agrandie au-del de la moiti
+typedef struct {
+    uint64_t *keys;       // UINT64_MAX when empty
+    uint32_t *values;
+    uint32_t  mask;
+    uint32_t  count;
+} PairMap;
+
+static void pairMapInit(PairMap *m, uint32_t expected) {
+    uint32_t size = 16;
+    while (size < 2 * (uint64_t)expected) size *= 2;
+    m->keys = xcalloc(size, sizeof(uint64_t));
+    m->values = xcalloc(size, sizeof(uint32_t));
+    memset(m->keys, 0xff, size * sizeof(uint64_t));
+    m->mask = size - 1;
+    m->count = 0;
+}
+
+static void pairMapFree(PairMap *m) {
+    free(m->keys);
+    free(m->values);
+}
+
+static inline uint32_t pairMapSlot(const PairMap *m, uint64_t key) {
+    uint32_t slot = (uint32_t)((key * UINT64_C(0x9e3779b97f4a7c15)) >> 32) & m->mask;
+    while (m->keys[slot] != UINT64_MAX && m->keys[slot] != key) slot = (slot + 1) & m->mask;
+    return slot;
+}
+
+// Value of key, DFA_NO_STATE if absent
+// Valeur de key, DFA_NO_STATE si absente
+static inline uint32_t pairMapGet(const PairMap *m, uint64_t key) {
+    uint32_t slot = pairMapSlot(m, key);
+    return m->keys[slot] == UINT64_MAX ? DFA_NO_STATE : m->values[slot];
+}
+
+// Inserts a key known to be absent
+// Insre une cl absente
+static void pairMapPut(PairMap *m, uint64_t key, uint32_t value) {
+    if (2 * (uint64_t)(m->count + 1) > (uint64_t)m->mask + 1) {
+        PairMap bigger;
+        pairMapInit(&bigger, m->mask + 1);
+        for (uint32_t i = 0; i <= m->mask; ++i) {
+            if (m->keys[i] == UINT64_MAX) continue;
+            uint32_t slot = pairMapSlot(&bigger, m->keys[i]);
+            bigger.keys[slot] = m->keys[i];
+            bigger.values[slot] = m->values[i];
+        }
+        bigger.count = m->count;
+        pairMapFree(m);
+        *m = bigger;
+    }
+    uint32_t slot = pairMapSlot(m, key);
+    m->keys[slot] = key;
+    m->values[slot] = value;
+    m->count++;
+}
+
+// Both DFAs side by side: state s of a is s, its sink nA, state s of b is
+// nA + 1 + s and its sink nA + 1 + nB. Columns are the joint symbol
+// classes, each with one symbol standing for it.
+// Les deux automates cte  cte : l'tat s de a est s, son puits nA,
+// l'tat s de b est nA + 1 + s et son puits nA + 1 + nB. Les colonnes sont
+// les classes de symboles communes, chacune avec un symbole qui la
+// reprsente.
+typedef struct {
+    const DfaMinimizer *a, *b;
+    uint32_t  nA, nB;
+    uint32_t  nColumns;
+    uint32_t *columnA;    // Class of a per column / Classe de a par colonne
+    uint32_t *columnB;
+    int      *symbol;     // Representative symbol / Symbole reprsentant
+} PairedDfas;
+
+static void pairedInit(PairedDfas *x, const DfaMinimizer *a, const DfaMinimizer *b) {
+    x->a = a;
+    x->b = b;
+    x->nA = a->nStates;
+    x->nB = b->nStates;
+    uint32_t k = a->alphabetSize;
+    bool compressed = a->intervalClass || b->intervalClass;
+    uint32_t runsA = a->intervalClass ? a->nIntervals : k;
+    uint32_t runsB = b->intervalClass ? b->nIntervals : k;
+    uint32_t maxRuns = runsA + runsB < k ? runsA + runsB : k;
+    x->columnA = xcalloc(maxRuns, sizeof(uint32_t));
+    x->columnB = xcalloc(maxRuns, sizeof(uint32_t));
+    x->symbol = xcalloc(maxRuns, sizeof(int));
+    x->nColumns = 0;
+
+    // The two interval lists are merged: symbols with the same pair of
+    // classes behave the same on both sides
+    // Les deux listes d'intervalles sont fusionnes : les symboles au mme
+    // couple de classes agissent pareil des deux cts
+    PairMap seen;
+    pairMapInit(&seen, compressed ? a->nClasses + b->nClasses : 0);
+    uint32_t ia = 0, ib = 0;
+    for (uint32_t sym = 0; sym < k;) {
+        uint32_t ca = a->intervalClass ? a->intervalClass[ia] : sym;
+        uint32_t cb = b->intervalClass ? b->intervalClass[ib] : sym;
+        uint32_t endA = a->intervalClass ? intervalEnd(a, ia) : sym + 1;
+        uint32_t endB = b->intervalClass ? intervalEnd(b, ib) : sym + 1;
+        bool fresh = true;
+        if (compressed) {
+            uint64_t key = (uint64_t)ca << 32 | cb;
+            fresh = pairMapGet(&seen, key) == DFA_NO_STATE;
+            if (fresh) pairMapPut(&seen, key, x->nColumns);
+        }
+        if (fresh) {
+            x->columnA[x->nColumns] = ca;
+            x->columnB[x->nColumns] = cb;
+            x->symbol[x->nColumns++] = (int)sym;
+        }
+        sym = endA < endB ? endA : endB;
+        if (sym == endA) ++ia;
+        if (sym == endB) ++ib;
+    }
+    pairMapFree(&seen);
+}
+
+static void pairedFree(PairedDfas *x) {
+    free(x->columnA);
+    free(x->columnB);
+    free(x->symbol);
+}
+
+// Successor of p in a (sink nA) on column j
+// Successeur de p dans a (puits nA) par la colonne j
+static inline uint32_t stepA(const PairedDfas *x, uint32_t p, uint32_t j) {
+    if (p == x->nA) return p;
+    uint32_t t = x->a->transitions[(size_t)p * x->a->nClasses + x->columnA[j]];
+    return t == DFA_NO_STATE ? x->nA : t;
+}
+
+static inline uint32_t stepB(const PairedDfas *x, uint32_t q, uint32_t j) {
+    if (q == x->nB) return q;
+    uint32_t t = x->b->transitions[(size_t)q * x->b->nClasses + x->columnB[j]];
+    return t == DFA_NO_STATE ? x->nB : t;
+}
+
+// Whether p of a and q of b agree on finality and output class (sinks are
+// non-final with class 0)
+// Indique si p de a et q de b s'accordent sur la finalit et la classe de
+// sortie (les puits sont non finaux de classe 0)
+static bool sameAnswer(const PairedDfas *x, uint32_t p, uint32_t q) {
+    bool finalA = p != x->nA && isFinalState(x->a, p);
+    bool finalB = q != x->nB && isFinalState(x->b, q);
+    int32_t outputA = p != x->nA ? stateOutput(x->a, p) : 0;
+    int32_t outputB = q != x->nB ? stateOutput(x->b, q) : 0;
+    return finalA == finalB && outputA == outputB;
+}
+
+// Union-find root with path halving
+// Racine union-find avec compression par moiti
+static inline uint32_t findRoot(uint32_t *parent, uint32_t v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// Union-find over the states of both sides, union by size
+// Union-find sur les tats des deux cts, union par taille
+typedef struct {
+    uint32_t *parent;
+    uint32_t *size;
+} UnionFind;
+
+// Merges the sets of u and v; false if they were already one set
+// Fusionne les ensembles de u et v ; faux s'ils n'en formaient dj qu'un
+static bool unionSets(UnionFind *uf, uint32_t u, uint32_t v) {
+    u = findRoot(uf->parent, u);
+    v = findRoot(uf->parent, v);
+    if (u == v) return false;
+    if (uf->size[u] < uf->size[v]) {
+        uint32_t swap = u;
+        u = v;
+        v = swap;
+    }
+    uf->parent[v] = u;
+    uf->size[u] += uf->size[v];
+    return true;
+}
+
+// Hopcroft-Karp: merges the initial states, then the successors of every
+// merged pair on each column; the languages differ exactly when a merged
+// pair disagrees. Each merge joins two sets, so at most nA + nB + 1 pairs
+// are ever queued, and the run is near-linear without minimizing either side.
+// Hopcroft-Karp : fusionne les tats initiaux, puis les successeurs de
+// chaque couple fusionn par chaque colonne ; les langages diffrent
+// exactement quand un couple fusionn est en dsaccord. Chaque fusion
+// runit deux ensembles : au plus nA + nB + 1 couples entrent dans la file,
+// en temps quasi linaire et sans minimiser aucun des deux cts.
+static bool unionFindEquivalent(const PairedDfas *x, uint32_t startA, uint32_t startB) {
+    uint32_t nNodes = x->nA + x->nB + 2;
+    UnionFind uf = { xcalloc(nNodes, sizeof(uint32_t)), xcalloc(nNodes, sizeof(uint32_t)) };
+    for (uint32_t v = 0; v < nNodes; ++v) {
+        uf.parent[v] = v;
+        uf.size[v] = 1;
+    }
+    uint32_t *queueA = xcalloc(nNodes, sizeof(uint32_t));
+    uint32_t *queueB = xcalloc(nNodes, sizeof(uint32_t));
+    uint32_t head = 0, tail = 0;
+
+    bool equal = sameAnswer(x, startA, startB);
+    if (equal && unionSets(&uf, startA, x->nA + 1 + startB)) {
+        queueA[tail] = startA;
+        queueB[tail++] = startB;
+    }
+    while (equal && head < tail) {
+        uint32_t p = queueA[head], q = queueB[head++];
+        for (uint32_t j = 0; j < x->nColumns && equal; ++j) {
+            uint32_t np = stepA(x, p, j), nq = stepB(x, q, j);
+            if (!unionSets(&uf, np, x->nA + 1 + nq)) continue;
+            equal = sameAnswer(x, np, nq);
+            queueA[tail] = np;
+            queueB[tail++] = nq;
+        }
+    }
+    free(queueB);
+    free(queueA);
+    free(uf.size);
+    free(uf.parent);
+    return equal;
+}
+
+// Breadth-first search of the product from (startA, startB) up to the first
+// pair that disagrees, which gives a shortest distinguishing word; only run
+// once the languages are known to differ. Returns the word length and
+// stores the symbols in *word (allocated).
+// Parcours en largeur du produit depuis (startA, startB) jusqu'au premier
+// couple en dsaccord, ce qui donne un mot distinguant le plus court ;
+// lanc seulement quand les langages sont connus diffrents. Renvoie la
+// longueur du mot et range les symboles dans *word (allou).
+static size_t shortestCounterexample(const PairedDfas *x, uint32_t startA, uint32_t startB, int **word) {
+    uint32_t capacity = 64, count = 0;
+    uint32_t *pairA = xcalloc(capacity, sizeof(uint32_t));
+    uint32_t *pairB = xcalloc(capacity, sizeof(uint32_t));
+    uint32_t *from = xcalloc(capacity, sizeof(uint32_t));     // Parent pair / Couple parent
+    uint32_t *column = xcalloc(capacity, sizeof(uint32_t));   // Column from the parent / Colonne depuis le parent
+    PairMap seen;
+    pairMapInit(&seen, capacity);
+
+    pairA[0] = startA;
+    pairB[0] = startB;
+    from[0] = DFA_NO_STATE;
+    count = 1;
+    pairMapPut(&seen, (uint64_t)startA << 32 | startB, 0);
+    uint32_t found = sameAnswer(x, startA, startB) ? DFA_NO_STATE : 0;
+    for (uint32_t head = 0; head < count && found == DFA_NO_STATE; ++head) {
+        for (uint32_t j = 0; j < x->nColumns && found == DFA_NO_STATE; ++j) {
+            uint32_t np = stepA(x, pairA[head], j), nq = stepB(x, pairB[head], j);
+            uint64_t key = (uint64_t)np << 32 | nq;
+            if (pairMapGet(&seen, key) != DFA_NO_STATE) continue;
+            if (count == capacity) {
+                capacity *= 2;
+                pairA = xrealloc(pairA, capacity, sizeof(uint32_t));
+                pairB = xrealloc(pairB, capacity, sizeof(uint32_t));
+                from = xrealloc(from, capacity, sizeof(uint32_t));
+                column = xrealloc(column, capacity, sizeof(uint32_t));
+            }
+            pairA[count] = np;
+            pairB[count] = nq;
+            from[count] = head;
+            column[count] = j;
+            pairMapPut(&seen, key, count);
+            if (!sameAnswer(x, np, nq)) found = count;
+            count++;
+        }
+    }
+
+    // Pairs are discovered level by level: the path back is shortest
+    // Les couples sont dcouverts niveau par niveau : le chemin est minimal
+    size_t length = 0;
+    for (uint32_t v = found; v != DFA_NO_STATE && from[v] != DFA_NO_STATE; v = from[v]) length++;
+    *word = xcalloc(length ? length : 1, sizeof(int));
+    size_t i = length;
+    for (uint32_t v = found; v != DFA_NO_STATE && from[v] != DFA_NO_STATE; v = from[v]) {
+        (*word)[--i] = x->symbol[column[v]];
+    }
+    pairMapFree(&seen);
+    free(column);
+    free(from);
+    free(pairB);
+    free(pairA);
+    return length;
+}
+
+DfaStatus dfaEquivalent(const DfaMinimizer *a, const DfaMinimizer *b, bool *equal, int **word, size_t *length) {
+    if (!a || !b || !equal || !word != !length || a->alphabetSize != b->alphabetSize) return DFA_ERR_INVALID;
+    if (word) {
+        *word = NULL;
+        *length = 0;
+    }
+    PairedDfas x;
+    pairedInit(&x, a, b);
+
+    // An empty DFA starts in its sink
+    // Un automate vide part de son puits
+    uint32_t startA = a->initialState == DFA_NO_STATE ? x.nA : a->initialState;
+    uint32_t startB = b->initialState == DFA_NO_STATE ? x.nB : b->initialState;
+    *equal = unionFindEquivalent(&x, startA, startB);
+    if (!*equal && word) *length = shortestCounterexample(&x, startA, startB, word);
+    pairedFree(&x);
+    return DFA_OK;
+}
@@ -0,0 +1,562 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+// Maps and lists of a pass live in the scratch arena, released as a whole
+// when the pass ends. A growing one leaves its old arrays behind (no more
+// than its final size), so it only grows while no later mark is live.
+// Les tables et listes d'une passe vivent dans l'arne de travail, libre
+// d'un bloc  la fin de la passe. Celles qui grandissent y laissent leurs
+// anciens tableaux (pas plus que leur taille finale) : elles ne grandissent
+// donc que si aucune marque ultrieure n'est active.
+
+// Open-addressing map from state or block ids to local ids
+// Table  adressage ouvert des numros d'tats ou de blocs vers des numros locaux
+typedef struct {
+    uint32_t *keys;       // DFA_NO_STATE when empty
+    uint32_t *values;
+    uint32_t  mask;
+    uint32_t  count;
+    ScratchArena *scratch;
+} IdMap;
+
+static void idMapInit(IdMap *m, uint32_t expected, ScratchArena *scratch) {
+    uint32_t size = 16;
+    while (size < 2 * (uint64_t)expected) size *= 2;
+    m->keys = arenaAlloc(scratch, size, sizeof(uint32_t));
+    m->values = arenaAlloc(scratch, size, sizeof(uint32_t));
+    memset(m->keys, 0xff, size * sizeof(uint32_t));
+    m->mask = size - 1;
+    m->count = 0;
+    m->scratch = scratch;
+}
+
+static inline uint32_t idMapSlot(const IdMap *m, uint32_t key) {
+    uint32_t slot = (uint32_t)(((uint64_t)key * UINT64_C(0x9e3779b97f4a7c15)) >> 32) & m->mask;
+    while (m->keys[slot] != DFA_NO_STATE && m->keys[slot] != key) slot = (slot + 1) & m->mask;
+    return slot;
+}
+
+// Value of key, DFA_NO_STATE if absent
+// Valeur de key, DFA_NO_STATE si absente
+static inline uint32_t idMapGet(const IdMap *m, uint32_t key) {
+    uint32_t slot = idMapSlot(m, key);
+    return m->keys[slot] == DFA_NO_STATE ? DFA_NO_STATE : m->values[slot];
+}
+
+// Inserts a key known to be absent, doubling the table past half load
+// Insre une cl absente, en doublant la table au-del de la moiti
+static void idMapPut(IdMap *m, uint32_t key, uint32_t value) {
+    if (2 * (uint64_t)(m->count + 1) > m->mask + 1) {
+        IdMap bigger;
+        idMapInit(&bigger, m->mask + 1, m->scratch);
+        for (uint32_t i = 0; i <= m->mask; ++i) {
+            if (m->keys[i] == DFA_NO_STATE) continue;
+            uint32_t slot = idMapSlot(&bigger, m->keys[i]);
+            bigger.keys[slot] = m->keys[i];
+            bigger.values[slot] = m->values[i];
+        }
+        bigger.count = m->count;
+        *m = bigger;
+    }
+    uint32_t slot = idMapSlot(m, key);
+    m->keys[slot] = key;
+    m->values[slot] = value;
+    m->count++;
+}
+
+// Growable list of ids
+// Liste extensible de numros
+typedef struct {
+    uint32_t *ids;
+    uint32_t  count;
+    uint32_t  capacity;
+    ScratchArena *scratch;
+} IdList;
+
+static void idListPush(IdList *l, uint32_t id) {
+    if (l->count == l->capacity) {
+        uint32_t *ids = arenaAlloc(l->scratch, l->capacity ? 2 * (size_t)l->capacity : 64, sizeof(uint32_t));
+        if (l->count) memcpy(ids, l->ids, l->count * sizeof(uint32_t));
+        l->ids = ids;
+        l->capacity = l->capacity ? l->capacity * 2 : 64;
+    }
+    l->ids[l->count++] = id;
+}
+
+// Transition of an edited row, listed by target (missing ones last, as
+// DFA_NO_STATE)
+// Transition d'une ligne modifie, range par cible (les absentes en
+// dernier, comme DFA_NO_STATE)
+typedef struct {
+    uint32_t target;
+    uint32_t source;
+} EditedEdge;
+
+static int compareEdges(const void *a, const void *b) {
+    const EditedEdge *x = a, *y = b;
+    if (x->target != y->target) return x->target < y->target ? -1 : 1;
+    return (x->source > y->source) - (x->source < y->source);
+}
+
+// Status of a class of the local automaton
+// Statut d'une classe de l'automate local
+enum { CLASS_OPEN, CLASS_OLD, CLASS_NEW };
+
+// State of one incremental pass. The region is the set of states that can
+// reach a changed state: only their languages may have changed. The other
+// states keep theirs, so the old blocks restricted to them stay exact and
+// pairwise distinct, and are closed under successors.
+// tat d'une passe incrmentale. La rgion est l'ensemble des tats qui
+// mnent  un tat modifi : seuls leurs langages ont pu changer. Les
+// autres gardent le leur, donc les anciens blocs restreints  eux restent
+// exacts et deux  deux distincts, et sont clos par successeurs.
+typedef struct {
+    const DfaMinimizer *d;
+    ScratchArena *scratch;
+    uint32_t    k;
+    IdMap       region;         // Region state -> local id
+    IdList      list;           // Region states, then one outside state per old block reached
+    uint32_t    nRegion;
+    EditedEdge *edges;
+    size_t      nEdges;
+
+    // Classes of the local automaton once minimized
+    // Classes de l'automate local une fois minimis
+    uint32_t    nLocal;
+    uint32_t   *classOf;        // Local id -> class
+    uint32_t   *classRep;       // First state of each class
+    uint32_t   *classRow;       // Successor classes, nLocal * k
+    uint8_t    *status;
+    uint32_t   *classBlock;     // Old block of a CLASS_OLD class
+    uint32_t   *tentBlock;      // Old block guessed during a pair walk
+    uint32_t   *tentRep;        // Outside state standing for tentBlock
+    IdList      walk;           // Classes of a pair walk, sized for all of them
+} IncrementalPass;
+
+static inline bool inRegion(const IncrementalPass *x, uint32_t s) {
+    return idMapGet(&x->region, s) != DFA_NO_STATE;
+}
+
+// Index of the first edited edge into target, by binary search
+// Indice du premier arc modifi vers target, par recherche dichotomique
+static size_t firstEdge(const IncrementalPass *x, uint32_t target) {
+    size_t lo = 0, hi = x->nEdges;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (x->edges[mid].target < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Lists the region, changed states first; predecessors come from the
+// index for unedited states and from the edited rows themselves
+// Liste la rgion, tats modifis en tte ; les prdcesseurs viennent de
+// l'index pour les tats non modifis et des lignes modifies elles-mmes
+static void collectRegion(IncrementalPass *x) {
+    const DfaMinimizer *d = x->d;
+    uint32_t k = x->k;
+    x->edges = arenaAlloc(x->scratch, (size_t)d->edited.count * k + 1, sizeof(EditedEdge));
+    for (uint32_t i = 0; i < d->edited.count; ++i) {
+        uint32_t p = d->edited.states[i];
+        const uint32_t *row = &d->transitions[(size_t)p * k];
+        for (uint32_t c = 0; c < k; ++c) x->edges[x->nEdges++] = (EditedEdge){ row[c], p };
+    }
+    qsort(x->edges, x->nEdges, sizeof(EditedEdge), compareEdges);
+
+    idMapInit(&x->region, d->changed.count, x->scratch);
+    for (uint32_t i = 0; i < d->changed.count; ++i) {
+        idMapPut(&x->region, d->changed.states[i], x->list.count);
+        idListPush(&x->list, d->changed.states[i]);
+    }
+    for (uint32_t head = 0; head < x->list.count; ++head) {
+        uint32_t t = x->list.ids[head];
+        if (t < d->inverseStates) {
+            size_t slot = (size_t)t * k;
+            for (uint32_t e = d->predStart[slot]; e < d->predStart[slot + k]; ++e) {
+                uint32_t p = d->preds[e];
+                if (stateSetHas(&d->edited, p) || inRegion(x, p)) continue;
+                idMapPut(&x->region, p, x->list.count);
+                idListPush(&x->list, p);
+            }
+        }
+        for (size_t e = firstEdge(x, t); e < x->nEdges && x->edges[e].target == t; ++e) {
+            uint32_t p = x->edges[e].source;
+            if (inRegion(x, p)) continue;
+            idMapPut(&x->region, p, x->list.count);
+            idListPush(&x->list, p);
+        }
+    }
+    x->nRegion = x->list.count;
+}
+
+// Coarsest partition of nInner states next to nAtoms atoms, each atom a
+// block of its own without transitions: rows hold an inner id, nInner plus
+// an atom, or DFA_NO_STATE, and inner states start from their nGroups
+// groups. Fills classOf for inner states then atoms and returns the class
+// count; atoms are never merged.
+// Partition la plus grossire de nInner tats  ct de nAtoms atomes,
+// chaque atome formant seul un bloc sans transition : les lignes
+// contiennent un numro interne, nInner plus un atome, ou DFA_NO_STATE, et
+// les tats internes partent de leurs nGroups groupes. Remplit classOf pour les tats internes puis les atomes et renvoie le
+// nombre de classes ; les atomes ne sont jamais fusionns.
+static uint32_t refineWithAtoms(uint32_t k, uint32_t nInner, uint32_t nAtoms, const uint32_t *rows,
+                                const uint32_t *group, uint32_t nGroups, uint32_t *classOf, ScratchArena *scratch) {
+    uint32_t n = nInner + nAtoms;
+    DfaMinimizer *local = dfaCreate(k);
+    dfaAddStates(local, n);
+    memcpy(local->transitions, rows, (size_t)nInner * k * sizeof(uint32_t));
+    ArenaMark mark = arenaMark(scratch);
+    uint32_t *blockOf = arenaAlloc(scratch, n, sizeof(uint32_t));
+    memcpy(blockOf, group, nInner * sizeof(uint32_t));
+    for (uint32_t j = 0; j < nAtoms; ++j) blockOf[nInner + j] = nGroups + j;
+    refinableInit(&local->partition, n, blockOf, nGroups + nAtoms, &local->scratch);
+    dfaRefine(local, DFA_ENGINE_HOPCROFT);
+    memcpy(classOf, local->partition.sidx, n * sizeof(uint32_t));
+    uint32_t nClasses = local->partition.nBlocks;
+    arenaRelease(scratch, mark);
+    dfaDestroy(local);
+    return nClasses;
+}
+
+// Minimizes the region next to the old blocks it leads to, as atoms: those
+// blocks are exact and distinct, so their successors need not be copied.
+// Classes holding an old block are that block, the others stay open.
+// Minimise la rgion avec les anciens blocs qu'elle atteint, comme
+// atomes : ces blocs sont exacts et distincts, inutile donc de copier
+// leurs successeurs. Les classes contenant un ancien bloc sont ce bloc,
+// les autres restent ouvertes.
+static void minimizeRegion(IncrementalPass *x) {
+    const DfaMinimizer *d = x->d;
+    const uint32_t *sidx = d->partition.sidx;
+    uint32_t k = x->k, nRegion = x->nRegion;
+    IdMap reached;
+    idMapInit(&reached, nRegion, x->scratch);
+    uint32_t *rows = arenaAlloc(x->scratch, (size_t)nRegion * k + 1, sizeof(uint32_t));
+    for (uint32_t i = 0; i < nRegion; ++i) {
+        const uint32_t *row = &d->transitions[(size_t)x->list.ids[i] * k];
+        for (uint32_t c = 0; c < k; ++c) {
+            uint32_t t = row[c], id = DFA_NO_STATE;
+            if (t != DFA_NO_STATE) id = idMapGet(&x->region, t);
+            if (t != DFA_NO_STATE && id == DFA_NO_STATE) {
+                id = idMapGet(&reached, sidx[t]);
+                if (id == DFA_NO_STATE) {
+                    id = x->list.count;
+                    idMapPut(&reached, sidx[t], id);
+                    idListPush(&x->list, t);
+                }
+            }
+            rows[(size_t)i * k + c] = id;
+        }
+    }
+    uint32_t *group = arenaAlloc(x->scratch, nRegion + 1, sizeof(uint32_t));
+    uint32_t nGroups = dfaOutputBlocks(d, x->list.ids, nRegion, group, x->scratch);
+    x->classOf = arenaAlloc(x->scratch, x->list.count, sizeof(uint32_t));
+    uint32_t n = x->nLocal = refineWithAtoms(k, nRegion, x->list.count - nRegion, rows, group, nGroups,
+                                             x->classOf, x->scratch);
+
+    // A walk lists each class at most once, and is filled under the marks
+    // of matchClass(): its list never grows
+    // Un parcours liste chaque classe au plus une fois, et se remplit sous
+    // les marques de matchClass() : sa liste ne grandit jamais
+    x->classRep = arenaAlloc(x->scratch, n, sizeof(uint32_t));
+    x->classRow = arenaAlloc(x->scratch, (size_t)n * k, sizeof(uint32_t));
+    x->status = arenaAlloc(x->scratch, n, sizeof(uint8_t));
+    x->classBlock = arenaAlloc(x->scratch, n, sizeof(uint32_t));
+    x->tentBlock = arenaAlloc(x->scratch, n, sizeof(uint32_t));
+    x->tentRep = arenaAlloc(x->scratch, n, sizeof(uint32_t));
+    x->walk = (IdList){ arenaAlloc(x->scratch, n, sizeof(uint32_t)), 0, n, x->scratch };
+    memset(x->classRep, 0xff, n * sizeof(uint32_t));
+    memset(x->classRow, 0xff, (size_t)n * k * sizeof(uint32_t));
+    memset(x->tentBlock, 0xff, n * sizeof(uint32_t));
+    for (uint32_t i = 0; i < x->list.count; ++i) {
+        uint32_t b = x->classOf[i];
+        if (x->classRep[b] != DFA_NO_STATE) continue;
+        x->classRep[b] = x->list.ids[i];
+        if (i >= nRegion) {
+            x->status[b] = CLASS_OLD;
+            x->classBlock[b] = sidx[x->list.ids[i]];
+            continue;
+        }
+        for (uint32_t c = 0; c < k; ++c) {
+            uint32_t t = rows[(size_t)i * k + c];
+            x->classRow[(size_t)b * k + c] = t == DFA_NO_STATE ? DFA_NO_STATE : x->classOf[t];
+        }
+    }
+}
+
+// Whether open class b and the old block of outside state p have the same
+// language: walks the pairs they lead to, guessing the old block of each
+// open class met. On success every guess holds and is kept.
+// Indique si la classe ouverte b et l'ancien bloc de l'tat extrieur p ont
+// le mme langage : parcourt les paires qu'ils atteignent, en supposant
+// l'ancien bloc de chaque classe ouverte rencontre. En cas de succs,
+// chaque supposition est vraie et conserve.
+static bool walkPairs(IncrementalPass *x, uint32_t b, uint32_t p) {
+    const DfaMinimizer *d = x->d;
+    const uint32_t *sidx = d->partition.sidx;
+    uint32_t k = x->k;
+    x->walk.count = 0;
+    x->tentBlock[b] = sidx[p];
+    x->tentRep[b] = p;
+    idListPush(&x->walk, b);
+    bool same = true;
+    for (uint32_t i = 0; same && i < x->walk.count; ++i) {
+        uint32_t e = x->walk.ids[i], r = x->tentRep[e];
+        const uint32_t *row = &d->transitions[(size_t)r * k];
+        const uint32_t *classRow = &x->classRow[(size_t)e * k];
+        same = sameOutput(d, x->classRep[e], r);
+        for (uint32_t c = 0; same && c < k; ++c) {
+            uint32_t next = classRow[c], q = row[c];
+            if (next == DFA_NO_STATE || q == DFA_NO_STATE) {
+                same = next == q;
+            } else if (x->status[next] != CLASS_OPEN) {
+                same = x->status[next] == CLASS_OLD && x->classBlock[next] == sidx[q];
+            } else if (x->tentBlock[next] == DFA_NO_STATE) {
+                x->tentBlock[next] = sidx[q];
+                x->tentRep[next] = q;
+                idListPush(&x->walk, next);
+            } else {
+                same = x->tentBlock[next] == sidx[q];
+            }
+        }
+    }
+    for (uint32_t i = 0; i < x->walk.count; ++i) {
+        uint32_t e = x->walk.ids[i];
+        if (same) {
+            x->status[e] = CLASS_OLD;
+            x->classBlock[e] = x->tentBlock[e];
+        }
+        x->tentBlock[e] = DFA_NO_STATE;
+    }
+    return same;
+}
+
+// Matches open class b against the old blocks that lead on column c to
+// where b does (block or sink): only those can have its language. Their
+// outside states are found through the index and the edited rows.
+// Compare la classe ouverte b aux anciens blocs qui mnent par la colonne
+// c l o b mne (bloc ou puits) : seuls ceux-l peuvent avoir son
+// langage. Leurs tats extrieurs sont trouvs par l'index et les lignes
+// modifies.
+static bool matchClass(IncrementalPass *x, uint32_t b, uint32_t c) {
+    const DfaMinimizer *d = x->d;
+    const RefinablePartition *P = &d->partition;
+    uint32_t k = x->k;
+    uint32_t next = x->classRow[(size_t)b * k + c];
+    uint32_t from = 0, to = 1;
+    if (next != DFA_NO_STATE) {
+        from = P->first[x->classBlock[next]];
+        to = P->end[x->classBlock[next]];
+    }
+
+    ArenaMark mark = arenaMark(x->scratch);
+    IdMap tried;
+    idMapInit(&tried, 16, x->scratch);
+    bool found = false;
+    for (uint32_t i = from; !found && i < to; ++i) {
+        // Target state q, the sink standing as DFA_NO_STATE
+        // tat cible q, le puits valant DFA_NO_STATE
+        uint32_t q = next == DFA_NO_STATE ? DFA_NO_STATE : P->elems[i];
+        if (q != DFA_NO_STATE && inRegion(x, q)) continue;
+        uint32_t row = q == DFA_NO_STATE ? d->inverseStates : q;
+        size_t e = firstEdge(x, q);
+        uint32_t lo = 0, hi = 0;
+        if (q == DFA_NO_STATE || q < d->inverseStates) {
+            lo = d->predStart[(size_t)row * k + c];
+            hi = d->predStart[(size_t)row * k + c + 1];
+        }
+        while (!found) {
+            uint32_t p;
+            if (lo < hi) {
+                p = d->preds[lo++];
+                if (p >= d->inverseStates || stateSetHas(&d->edited, p)) continue;
+            } else if (e < x->nEdges && x->edges[e].target == q) {
+                p = x->edges[e++].source;
+                if (d->transitions[(size_t)p * k + c] != q) continue;
+            } else {
+                break;
+            }
+            if (inRegion(x, p) || idMapGet(&tried, P->sidx[p]) != DFA_NO_STATE) continue;
+            idMapPut(&tried, P->sidx[p], 0);
+            found = walkPairs(x, b, p);
+        }
+    }
+    arenaRelease(x->scratch, mark);
+    return found;
+}
+
+// Column on which b leads to an old block (the smallest) or to the sink,
+// DFA_NO_STATE if every successor is open
+// Colonne par laquelle b mne  un ancien bloc (le plus petit) ou au puits,
+// DFA_NO_STATE si tous ses successeurs sont ouverts
+static uint32_t anchorColumn(const IncrementalPass *x, uint32_t b) {
+    const RefinablePartition *P = &x->d->partition;
+    uint32_t best = DFA_NO_STATE, bestSize = UINT32_MAX;
+    for (uint32_t c = 0; c < x->k; ++c) {
+        uint32_t next = x->classRow[(size_t)b * x->k + c];
+        uint32_t size;
+        if (next == DFA_NO_STATE) size = UINT32_MAX - 1;
+        else if (x->status[next] == CLASS_OLD) size = P->end[x->classBlock[next]] - P->first[x->classBlock[next]];
+        else continue;
+        if (size < bestSize) {
+            best = c;
+            bestSize = size;
+        }
+    }
+    return best;
+}
+
+// Settles every open class as an old block or a new one. A class leading
+// to a new class is new; a class leading to an old block or the sink is
+// matched through it. Returns false if open classes remain, all of them
+// leading only to one another.
+// Fixe chaque classe ouverte comme ancien bloc ou nouveau bloc. Une classe
+// qui mne  une nouvelle classe est nouvelle ; une classe qui mne  un
+// ancien bloc ou au puits est compare par ce biais. Renvoie false s'il
+// reste des classes ouvertes, qui ne mnent alors qu'entre elles.
+static bool settleClasses(IncrementalPass *x) {
+    uint32_t n = x->nLocal, k = x->k;
+
+    // Predecessor classes, to revisit a class when a successor settles
+    // Classes prdcesseurs, pour revoir une classe quand un successeur est fix
+    ArenaMark mark = arenaMark(x->scratch);
+    uint32_t *predStart = arenaAlloc(x->scratch, (size_t)n + 1, sizeof(uint32_t));
+    uint32_t *preds = arenaAlloc(x->scratch, (size_t)n * k + 1, sizeof(uint32_t));
+    for (size_t i = 0; i < (size_t)n * k; ++i) {
+        if (x->classRow[i] != DFA_NO_STATE) predStart[x->classRow[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < n; ++b) predStart[b + 1] += predStart[b];
+    for (size_t i = 0; i < (size_t)n * k; ++i) {
+        if (x->classRow[i] != DFA_NO_STATE) preds[predStart[x->classRow[i]]++] = (uint32_t)(i / k);
+    }
+    memmove(predStart + 1, predStart, n * sizeof(uint32_t));
+    predStart[0] = 0;
+
+    IdList work = { .scratch = x->scratch };
+    for (uint32_t b = 0; b < n; ++b) {
+        if (x->status[b] == CLASS_OPEN) idListPush(&work, b);
+    }
+    while (work.count > 0) {
+        uint32_t b = work.ids[--work.count];
+        if (x->status[b] != CLASS_OPEN) continue;
+        bool leadsToNew = false;
+        for (uint32_t c = 0; c < k; ++c) {
+            uint32_t next = x->classRow[(size_t)b * k + c];
+            leadsToNew = leadsToNew || (next != DFA_NO_STATE && x->status[next] == CLASS_NEW);
+        }
+        uint32_t c = leadsToNew ? DFA_NO_STATE : anchorColumn(x, b);
+        if (!leadsToNew && c == DFA_NO_STATE) continue;
+
+        if (leadsToNew || !matchClass(x, b, c)) {
+            x->status[b] = CLASS_NEW;
+            for (uint32_t e = predStart[b]; e < predStart[b + 1]; ++e) idListPush(&work, preds[e]);
+            continue;
+        }
+        // The walk settled b and possibly other classes, still listed in it
+        // Le parcours a fix b et peut-tre d'autres classes, qu'il liste encore
+        for (uint32_t i = 0; i < x->walk.count; ++i) {
+            uint32_t matched = x->walk.ids[i];
+            for (uint32_t e = predStart[matched]; e < predStart[matched + 1]; ++e) {
+                if (x->status[preds[e]] == CLASS_OPEN) idListPush(&work, preds[e]);
+            }
+        }
+    }
+
+    bool settled = true;
+    for (uint32_t b = 0; b < n; ++b) settled = settled && x->status[b] != CLASS_OPEN;
+    arenaRelease(x->scratch, mark);
+    return settled;
+}
+
+// Numbers the new classes after the old blocks. Two of them may still
+// have the same language, through classes matched since the first
+// minimization, so they are minimized again next to the old blocks they
+// lead to, as atoms.
+// Numrote les nouvelles classes aprs les anciens blocs. Deux d'entre
+// elles peuvent encore avoir le mme langage, par des classes compares
+// depuis la premire minimisation : elles sont donc minimises  nouveau 
+// ct des anciens blocs qu'elles atteignent, comme atomes.
+static uint32_t numberNewClasses(IncrementalPass *x) {
+    const DfaMinimizer *d = x->d;
+    uint32_t k = x->k, nBlocks = d->partition.nBlocks;
+    ArenaMark mark = arenaMark(x->scratch);
+    uint32_t *innerOf = arenaAlloc(x->scratch, x->nLocal, sizeof(uint32_t));
+    IdList inner = { .scratch = x->scratch };
+    for (uint32_t b = 0; b < x->nLocal; ++b) {
+        if (x->status[b] == CLASS_OLD) continue;
+        innerOf[b] = inner.count;
+        idListPush(&inner, b);
+    }
+    if (inner.count == 0) {
+        arenaRelease(x->scratch, mark);
+        return nBlocks;
+    }
+
+    IdMap atoms;
+    idMapInit(&atoms, inner.count, x->scratch);
+    uint32_t *rows = arenaAlloc(x->scratch, (size_t)inner.count * k, sizeof(uint32_t));
+    uint32_t *reps = arenaAlloc(x->scratch, inner.count, sizeof(uint32_t));
+    for (uint32_t i = 0; i < inner.count; ++i) {
+        uint32_t b = inner.ids[i];
+        reps[i] = x->classRep[b];
+        for (uint32_t c = 0; c < k; ++c) {
+            uint32_t next = x->classRow[(size_t)b * k + c], id = DFA_NO_STATE;
+            if (next != DFA_NO_STATE && x->status[next] != CLASS_OLD) {
+                id = innerOf[next];
+            } else if (next != DFA_NO_STATE) {
+                id = idMapGet(&atoms, x->classBlock[next]);
+                if (id == DFA_NO_STATE) {
+                    id = inner.count + atoms.count;
+                    idMapPut(&atoms, x->classBlock[next], id);
+                }
+            }
+            rows[(size_t)i * k + c] = id;
+        }
+    }
+    uint32_t *group = arenaAlloc(x->scratch, inner.count, sizeof(uint32_t));
+    uint32_t nGroups = dfaOutputBlocks(d, reps, inner.count, group, x->scratch);
+    uint32_t *classOf = arenaAlloc(x->scratch, inner.count + atoms.count, sizeof(uint32_t));
+    uint32_t nClasses = refineWithAtoms(k, inner.count, atoms.count, rows, group, nGroups, classOf, x->scratch);
+
+    // Inner classes never hold an atom
+    // Les classes internes ne contiennent jamais d'atome
+    uint32_t *newBlock = arenaAlloc(x->scratch, nClasses, sizeof(uint32_t));
+    memset(newBlock, 0xff, nClasses * sizeof(uint32_t));
+    for (uint32_t i = 0; i < inner.count; ++i) {
+        uint32_t c = classOf[i];
+        if (newBlock[c] == DFA_NO_STATE) newBlock[c] = nBlocks++;
+        x->classBlock[inner.ids[i]] = newBlock[c];
+    }
+
+    arenaRelease(x->scratch, mark);
+    return nBlocks;
+}
+
+uint32_t dfaIncrementalBlocks(DfaMinimizer *d, uint32_t *blockOf) {
+    IncrementalPass x = { .d = d, .scratch = &d->scratch, .k = d->nClasses };
+    x.list.scratch = &d->scratch;
+    ArenaMark mark = arenaMark(&d->scratch);
+    collectRegion(&x);
+    minimizeRegion(&x);
+
+    // Open classes leading only to one another could still match outside
+    // states through a cycle: left to a full refinement, unless the region
+    // is the whole automaton
+    // Des classes ouvertes qui ne mnent qu'entre elles pourraient encore
+    // galer des tats extrieurs par un cycle : laisses  un raffinement
+    // complet, sauf si la rgion couvre tout l'automate
+    uint32_t nBlocks = 0;
+    if (settleClasses(&x) || x.nRegion == d->nStates) {
+        nBlocks = numberNewClasses(&x);
+        if (d->partition.nElems) memcpy(blockOf, d->partition.sidx, d->partition.nElems * sizeof(uint32_t));
+        for (uint32_t i = 0; i < x.nRegion; ++i) blockOf[x.list.ids[i]] = x.classBlock[x.classOf[i]];
+    }
+
+    arenaRelease(&d->scratch, mark);
+    return nBlocks;
+}
@@ -0,0 +1,464 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+// Internal layout of the minimizer context, shared by the library sources
+// (not installed; applications use DFA_Minimizer.h only).
+// Organisation interne du contexte, partage par les sources de la
+// bibliothque (non installe ; les applications n'utilisent que DFA_Minimizer.h).
+#ifndef DFA_INTERNAL_H
+#define DFA_INTERNAL_H
+
+#include "DFA_Minimizer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Per-alphabet fast paths: hot loops are written once as force-inlined
+// kernels taking k, and DISPATCH_ALPHABET instantiates them with k as a
+// compile-time constant for the common sizes (2, 4 and bytes), falling back
+// to the runtime value otherwise.
+// Chemins rapides par alphabet : les boucles critiques sont crites une fois
+// en noyaux toujours inlins prenant k, et DISPATCH_ALPHABET les instancie
+// avec k constant pour les tailles courantes (2, 4 et octets), sinon avec
+// la valeur  l'excution.
+#if defined(__GNUC__)
+#define DFA_ALWAYS_INLINE static inline __attribute__((always_inline))
+#else
+#define DFA_ALWAYS_INLINE static inline
+#endif
+
+#define DISPATCH_ALPHABET(k, kernel, ...)                      \
+    do {                                                       \
+        switch (k) {                                           \
+        case 2:   kernel(__VA_ARGS__, 2); break;               \
+        case 4:   kernel(__VA_ARGS__, 4); break;               \
+        case 256: kernel(__VA_ARGS__, 256); break;             \
+        default:  kernel(__VA_ARGS__, k); break;               \
+        }                                                      \
+    } while (0)
+
+// Scratch arena: the temporary arrays of trimming and refinement are bumped
+// out of one block that outlives the call, so rounds and successive DFAs
+// reuse the same memory instead of going back to malloc. Allocations are
+// released in stack order with arenaRelease(); a request that does not fit
+// gets a heap block of its own, and the main block grows to the peak once
+// the arena is empty again.
+// Arne de travail : les tableaux temporaires du nettoyage et du
+// raffinement sont pris par incrment dans un bloc qui survit  l'appel, si
+// bien que les passes et les automates successifs rutilisent la mme
+// mmoire au lieu de revenir  malloc. Les allocations sont libres en
+// ordre de pile par arenaRelease() ; une demande qui ne tient pas reoit son
+// propre bloc du tas, et le bloc principal grandit jusqu'au pic une fois
+// l'arne de nouveau vide.
+typedef struct {
+    unsigned char *base;           // Main block
+    size_t    capacity;
+    size_t    used;
+    void    **overflow;            // Heap blocks taken while the main block was full
+    size_t   *overflowSize;
+    uint32_t  nOverflow;
+    uint32_t  overflowCapacity;
+    size_t    live;                // Bytes handed out and not yet released
+    size_t    peak;                // Most bytes live at once
+} ScratchArena;
+
+typedef struct {
+    size_t   used;
+    uint32_t nOverflow;
+} ArenaMark;
+
+static inline ArenaMark arenaMark(const ScratchArena *a) {
+    ArenaMark mark = { a->used, a->nOverflow };
+    return mark;
+}
+
+// Zeroed array of count elements of size bytes, aborting on overflow
+// Tableau initialis  zro de count lments de size octets, abandonne en cas de dbordement
+void *arenaAlloc(ScratchArena *a, size_t count, size_t size);
+
+// Releases everything allocated since mark
+// Libre tout ce qui a t allou depuis mark
+void arenaRelease(ScratchArena *a, ArenaMark mark);
+
+void arenaFree(ScratchArena *a);
+
+// Refinable partition (Valmari & Lehtinen): elems lists the elements
+// grouped by block, block b owning elems[first[b] .. end[b]); loc is the
+// inverse of elems and sidx gives the block of each element. Marking moves
+// an element to elems[first[b] .. mid[b]) and records b in touched, so a
+// split costs O(marked elements) and nothing is ever copied.
+// Partition raffinable (Valmari et Lehtinen) : elems range les lments
+// par bloc, le bloc b possdant elems[first[b] .. end[b]) ; loc est
+// l'inverse de elems et sidx donne le bloc de chaque lment. Marquer
+// dplace un lment dans elems[first[b] .. mid[b]) et note b dans
+// touched : une division cote O(lments marqus), sans aucune copie.
+typedef struct {
+    uint32_t *elems;      // Elements grouped by block
+    uint32_t *loc;        // Position of each element in elems
+    uint32_t *sidx;       // Block of each element
+    uint32_t *first;      // Block bounds in elems, marked part first
+    uint32_t *end;
+    uint32_t *mid;
+    uint32_t *touched;    // Blocks with marked elements
+    uint32_t  nTouched;
+    uint32_t  nBlocks;
+    uint32_t  nElems;
+    uint32_t  capacity;   // Allocated elements, reused by refinableInit()
+} RefinablePartition;
+
+// States listed once each, in insertion order, with a membership bitset
+// tats lists une fois chacun, dans l'ordre d'insertion, avec un ensemble
+// de bits d'appartenance
+typedef struct {
+    uint32_t *states;
+    uint32_t  count;
+    uint32_t  capacity;
+    uint64_t *bits;
+    uint32_t  words;
+} StateSet;
+
+// Minimizer context: the DFA as flat arrays indexed by state id (struct of
+// arrays), plus the partitions and scratch arrays of the minimization.
+// Contexte du minimiseur : l'automate en tableaux plats indexs par numro
+// d'tat (structure de tableaux), plus les partitions et tableaux de travail.
+//
+// transitions[state * nClasses + column] holds the target id or
+// DFA_NO_STATE, finality is a bitset and output classes an optional array;
+// the partition is kept apart. Columns are the symbols themselves until
+// dfaCompressAlphabet() merges identical ones, after which the alphabet is
+// cut into sorted intervals of consecutive symbols, each mapped to its
+// column: memory and work then follow the number of intervals, not the
+// number of symbols. Edits that split a class take a spare column, the
+// columns and intervals growing geometrically.
+// transitions[tat * nClasses + colonne] contient la cible ou
+// DFA_NO_STATE, les tats finaux forment un ensemble de bits et les classes
+// de sortie un tableau facultatif ; la partition est  part. Les colonnes
+// sont les symboles jusqu' ce que dfaCompressAlphabet() fusionne celles qui
+// sont identiques ; l'alphabet est alors dcoup en intervalles tris de
+// symboles conscutifs, chacun associ  sa colonne : mmoire et travail
+// suivent le nombre d'intervalles, non celui des symboles. Les
+// modifications qui sparent une classe prennent une colonne de rserve,
+// colonnes et intervalles croissant gomtriquement.
+struct DfaMinimizer {
+    uint32_t *transitions;        // Transition table
+    uint64_t *finalBits;          // Final/accepting states bitset
+    int32_t  *outputs;            // Output class per state, NULL while all are 0
+    char    (*stateNames)[4];     // State names (3 chars max)
+    uint32_t  nStates;            // Current number of states
+    uint32_t  statesCapacity;     // Allocated slots per array
+    uint32_t  initialState;       // Start state (DFA_NO_STATE while empty)
+    uint32_t  alphabetSize;       // Number of symbols k, chosen at creation
+    uint32_t  nClasses;           // Table columns (k until compressed)
+    uint32_t  spareClasses;       // Trailing columns no interval uses yet, all DFA_NO_STATE
+    uint32_t  nIntervals;         // Symbol intervals (0 while uncompressed)
+    uint32_t  intervalsCapacity;  // Allocated intervals (at most nIntervals: exact size)
+    uint32_t *intervalStart;      // First symbol of each interval, increasing from 0
+    uint32_t *intervalClass;      // Column of each interval, NULL while uncompressed
+    uint32_t *classIntervals;     // Intervals per column, NULL until an edit needs it
+
+    void     *mapping;            // Read-only file image the arrays may point into
+    size_t    mappingSize;        // (copy-on-write private mapping), or NULL
+
+    RefinablePartition partition;  // Blocks of the current partition (none until dfaInitialPartition)
+    ScratchArena scratch;          // Temporary arrays of trimming and refinement
+
+    // Inverse transitions, built by dfaTrim() or on first use: the
+    // predecessors of target t on column c are
+    // preds[predStart[t * nClasses + c] .. predStart[t * nClasses + c + 1]),
+    // t == inverseStates being the virtual sink that missing transitions lead
+    // to. Edits do not drop the index but list the states whose row changed
+    // in edited; the entries of the other states stay exact, and
+    // dfaEnsureInverse() rebuilds the index when edited is not empty.
+    // Transitions inverses, construites par dfaTrim() ou au premier usage :
+    // les prdcesseurs de la cible t par la colonne c sont
+    // preds[predStart[t * nClasses + c] .. ], t == inverseStates tant le
+    // puits virtuel des transitions absentes. Les modifications gardent
+    // l'index mais listent dans edited les tats dont la ligne a chang ;
+    // les entres des autres restent exactes, et dfaEnsureInverse()
+    // reconstruit l'index si edited n'est pas vide.
+    uint32_t *predStart;           // (inverseStates + 1) * nClasses + 1 offsets, or NULL
+    uint32_t *preds;               // (inverseStates + 1) * nClasses state ids
+    uint32_t  inverseStates;       // nStates when the index was built
+    StateSet  edited;              // States whose row changed since the index was built
+
+    // Edits since the partition was built, and whether it was then refined:
+    // dfaReminimize() starts from both
+    // Modifications depuis la construction de la partition, et si elle
+    // tait alors raffine : dfaReminimize() part des deux
+    StateSet  changed;
+    bool      refined;
+
+    bool  acyclic;                 // dfaTrim() found no cycle; cleared by any edit
+    bool *reachable;               // Reachable states during cleanup
+    bool *coReachable;             // Co-reachable states during cleanup
+
+    FILE *trace;                   // Partition trace output, or NULL
+    int   nThreads;                // Threads for parallel engines (0: all CPUs)
+};
+
+// One NFA transition
+// Une transition d'automate non dterministe
+typedef struct {
+    uint32_t from;
+    uint32_t sym;
+    uint32_t to;
+} NfaEdge;
+
+// NFA: any number of initial states and of targets per (state, symbol),
+// stored as an edge list that algorithms index as they need
+// Automate non dterministe : un nombre quelconque d'tats initiaux et de
+// cibles par (tat, symbole), stock en liste d'arcs indexe au besoin
+struct DfaNfa {
+    uint32_t  alphabetSize;
+    uint32_t  nStates;
+    uint32_t  statesCapacity;
+    uint64_t *initialBits;         // Initial states bitset
+    uint64_t *finalBits;           // Final states bitset
+    NfaEdge  *edges;
+    size_t    nEdges;
+    size_t    edgesCapacity;
+};
+
+// Allocates a zeroed array or aborts
+// Alloue un tableau initialis  zro ou abandonne
+static inline void *xcalloc(size_t count, size_t size) {
+    void *p = calloc(count ? count : 1, size);
+    if (!p) {
+        perror("calloc failed");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Resizes an array or aborts
+// Redimensionne un tableau ou abandonne
+static inline void *xrealloc(void *ptr, size_t count, size_t size) {
+    void *p = realloc(ptr, (count ? count : 1) * size);
+    if (!p) {
+        perror("realloc failed");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Whether s is in the set
+// Indique si s est dans l'ensemble
+static inline bool stateSetHas(const StateSet *set, uint32_t s) {
+    return (s >> 6) < set->words && ((set->bits[s >> 6] >> (s & 63)) & 1);
+}
+
+// Adds s to the set if it is not there yet
+// Ajoute s  l'ensemble s'il n'y est pas encore
+static inline void stateSetAdd(StateSet *set, uint32_t s) {
+    if (stateSetHas(set, s)) return;
+    if ((s >> 6) >= set->words) {
+        uint32_t words = set->words ? set->words : 1;
+        while (words <= (s >> 6)) words *= 2;
+        set->bits = xrealloc(set->bits, words, sizeof(uint64_t));
+        memset(set->bits + set->words, 0, (words - set->words) * sizeof(uint64_t));
+        set->words = words;
+    }
+    if (set->count == set->capacity) {
+        set->capacity = set->capacity ? set->capacity * 2 : 64;
+        set->states = xrealloc(set->states, set->capacity, sizeof(uint32_t));
+    }
+    set->bits[s >> 6] |= UINT64_C(1) << (s & 63);
+    set->states[set->count++] = s;
+}
+
+// Empties the set in O(count), keeping its storage
+// Vide l'ensemble en O(count), en gardant sa mmoire
+static inline void stateSetClear(StateSet *set) {
+    for (uint32_t i = 0; i < set->count; ++i) set->bits[set->states[i] >> 6] = 0;
+    set->count = 0;
+}
+
+static inline void stateSetFree(StateSet *set) {
+    free(set->states);
+    free(set->bits);
+    memset(set, 0, sizeof(*set));
+}
+
+// Interval holding sym on a compressed alphabet, by binary search
+// Intervalle contenant sym d'un alphabet compress, par recherche dichotomique
+static inline uint32_t symbolInterval(const DfaMinimizer *d, uint32_t sym) {
+    uint32_t lo = 0, hi = d->nIntervals;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (d->intervalStart[mid] <= sym) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// One past the last symbol of interval i
+// Symbole suivant le dernier de l'intervalle i
+static inline uint32_t intervalEnd(const DfaMinimizer *d, uint32_t i) {
+    return i + 1 < d->nIntervals ? d->intervalStart[i + 1] : d->alphabetSize;
+}
+
+// Table column of sym
+// Colonne de la table du symbole sym
+static inline uint32_t symbolColumn(const DfaMinimizer *d, uint32_t sym) {
+    return d->intervalClass ? d->intervalClass[symbolInterval(d, sym)] : sym;
+}
+
+// Finality bitset accessors
+// Accesseurs de l'ensemble de bits des tats finaux
+static inline bool isFinalState(const DfaMinimizer *d, uint32_t s) {
+    return (d->finalBits[s >> 6] >> (s & 63)) & 1;
+}
+
+static inline void setFinalState(DfaMinimizer *d, uint32_t s, bool isFinal) {
+    if (isFinal) d->finalBits[s >> 6] |= UINT64_C(1) << (s & 63);
+    else d->finalBits[s >> 6] &= ~(UINT64_C(1) << (s & 63));
+}
+
+// Output class of s (0 unless set)
+// Classe de sortie de s (0 sauf si elle est dfinie)
+static inline int32_t stateOutput(const DfaMinimizer *d, uint32_t s) {
+    return d->outputs ? d->outputs[s] : 0;
+}
+
+// Whether s and t have the same finality and output class
+// Indique si s et t ont la mme finalit et la mme classe de sortie
+static inline bool sameOutput(const DfaMinimizer *d, uint32_t s, uint32_t t) {
+    return isFinalState(d, s) == isFinalState(d, t) && stateOutput(d, s) == stateOutput(d, t);
+}
+
+// Sets p to the blocks of blockOf (ids below nBlocks) over nElems elements:
+// blocks keep the order of their ids, empty ids are dropped, and each block
+// lists its elements in increasing order. The arrays of p are kept when
+// large enough; scratch holds the temporary ones.
+// Donne  p les blocs de blockOf (numros infrieurs  nBlocks) sur nElems
+// lments : les blocs gardent l'ordre de leurs numros, les numros vides
+// sont omis, et chaque bloc liste ses lments par ordre croissant. Les
+// tableaux de p sont gards s'ils suffisent ; scratch reoit les temporaires.
+void refinableInit(RefinablePartition *p, uint32_t nElems, const uint32_t *blockOf, uint32_t nBlocks,
+                   ScratchArena *scratch);
+
+// Releases the arrays of p and leaves it empty
+// Libre les tableaux de p et le laisse vide
+void refinableFree(RefinablePartition *p);
+
+// Marks e by moving it to the front of its block, recording the block in
+// touched when it is the block's first mark
+// Marque e en le dplaant en tte de son bloc, et note le bloc dans
+// touched  sa premire marque
+static inline void refinableMark(RefinablePartition *p, uint32_t e, uint32_t *touched, uint32_t *nTouched) {
+    uint32_t b = p->sidx[e];
+    uint32_t i = p->loc[e];
+    if (i < p->mid[b]) return;
+    if (p->mid[b] == p->first[b]) touched[(*nTouched)++] = b;
+    uint32_t other = p->elems[p->mid[b]];
+    p->elems[i] = other; p->loc[other] = i;
+    p->elems[p->mid[b]] = e; p->loc[e] = p->mid[b];
+    p->mid[b]++;
+}
+
+// Splits touched block b between its marked and unmarked elements, the
+// smaller half becoming block z, and clears the marks. Returns false,
+// leaving z unused, when every element of b was marked.
+// Divise le bloc touch b entre lments marqus et non marqus, la plus
+// petite moiti devenant le bloc z, et efface les marques. Renvoie faux,
+// sans utiliser z, si tous les lments de b taient marqus.
+static inline bool refinableSplit(RefinablePartition *p, uint32_t b, uint32_t z) {
+    uint32_t m = p->mid[b];
+    p->mid[b] = p->first[b];
+    if (m == p->end[b]) return false;
+    if (m - p->first[b] <= p->end[b] - m) {
+        p->first[z] = p->first[b]; p->end[z] = m; p->first[b] = m;
+    } else {
+        p->first[z] = m; p->end[z] = p->end[b]; p->end[b] = m;
+    }
+    p->mid[b] = p->first[b];
+    p->mid[z] = p->first[z];
+    for (uint32_t i = p->first[z]; i < p->end[z]; ++i) p->sidx[p->elems[i]] = z;
+    return true;
+}
+
+// Brzozowski refinement (DFA_Brzozowski.c): classifies every state by the
+// subsets of the reverse determinization that contain it, the sink kept
+// apart; fills blockOf and returns the block count, blocks being numbered
+// by first occurrence in state order. Returns 0 when the subsets outgrow
+// their budget.
+// Raffinement de Brzozowski (DFA_Brzozowski.c) : classe chaque tat selon
+// les sous-ensembles de la dterminisation inverse qui le contiennent, le
+// puits  part ; remplit blockOf et renvoie le nombre de blocs, numrots
+// par premire apparition dans l'ordre des tats. Renvoie 0 si les
+// sous-ensembles dpassent leur budget.
+uint32_t dfaBrzozowskiBlocks(DfaMinimizer *d, uint32_t *blockOf);
+
+// Groups count states (states[i], or i when states is NULL) by finality and
+// output class, in O(count): final groups first, each side numbered by
+// first occurrence. Fills blockOf[i] and returns the group id bound; the
+// temporary tables come from scratch.
+// Groupe count tats (states[i], ou i si states est NULL) par finalit et
+// classe de sortie, en O(count) : groupes finaux d'abord, chaque ct
+// numrot par premire apparition. Remplit blockOf[i] et renvoie la borne
+// des numros de groupe ; les tables temporaires viennent de scratch.
+uint32_t dfaOutputBlocks(const DfaMinimizer *d, const uint32_t *states, uint32_t count, uint32_t *blockOf,
+                         ScratchArena *scratch);
+
+// Builds the inverse transition index if it is missing or stale, O(n + m)
+// Construit l'index des transitions inverses s'il manque ou est prim, O(n + m)
+void dfaEnsureInverse(DfaMinimizer *d);
+
+// Incremental refinement (DFA_Incremental.c): from a refined partition and
+// the states changed since, re-refines only the states that can reach a
+// change, next to the classes they lead to, then matches the new classes
+// against the old blocks; the index may be stale. Fills blockOf and
+// returns the block count (ids of unchanged blocks are kept, new ones
+// follow), or 0 when new classes form cycles that only a full refinement
+// can match.
+// Raffinement incrmental (DFA_Incremental.c) :  partir d'une partition
+// raffine et des tats modifis depuis, ne raffine  nouveau que les
+// tats qui mnent  une modification, avec les classes qu'ils atteignent,
+// puis compare les nouvelles classes aux anciens blocs ; l'index peut tre
+// prim. Remplit blockOf et renvoie le nombre de blocs (les blocs
+// inchangs gardent leur numro, les nouveaux suivent), ou 0 si de
+// nouvelles classes forment des cycles que seul un raffinement complet
+// peut comparer.
+uint32_t dfaIncrementalBlocks(DfaMinimizer *d, uint32_t *blockOf);
+
+// Digit of the Moore signature of s (radix and parallel engines): digit 0
+// is the block of s, digit c + 1 the block of its successor on column c
+// (0 for the sink)
+// Chiffre de la signature de Moore de s (moteurs par base et parallle) :
+// le chiffre 0 est le bloc de s, le chiffre c + 1 celui de son successeur
+// par la colonne c (0 pour le puits)
+DFA_ALWAYS_INLINE uint32_t signatureDigit(const DfaMinimizer *d, const uint32_t *blockOf, uint32_t s,
+                                          uint32_t digit, const uint32_t k) {
+    if (digit == 0) return blockOf[s];
+    uint32_t t = d->transitions[(size_t)s * k + digit - 1];
+    return t == DFA_NO_STATE ? 0 : blockOf[t] + 1;
+}
+
+// Gives the context private heap copies of every array that still points
+// into a mapped file, then unmaps it (no-op for heap-only contexts)
+// Donne au contexte des copies prives de chaque tableau pointant encore
+// dans un fichier projet, puis le libre (sans effet sinon)
+void dfaDetachMapping(DfaMinimizer *d);
+
+// Unmaps the file image, forgetting the arrays that live in it
+// Libre l'image du fichier, en oubliant les tableaux qui s'y trouvent
+void dfaReleaseMapping(DfaMinimizer *d);
+
+// Parallel Moore refinement of the current partition (DFA_Parallel.c):
+// fills blockOf and returns the block count, blocks being numbered by
+// first occurrence in state order
+// Raffinement de Moore parallle de la partition courante (DFA_Parallel.c) :
+// remplit blockOf et renvoie le nombre de blocs, numrots par premire
+// apparition dans l'ordre des tats
+uint32_t dfaParallelMooreBlocks(DfaMinimizer *d, uint32_t *blockOf);
+
+// Parallel Hopcroft refinement from the final / non-final split
+// (DFA_Parallel.c): fills blockOf and returns the number of block ids used;
+// ids depend on scheduling, so callers renumber them
+// Raffinement de Hopcroft parallle depuis la sparation finaux / non
+// finaux (DFA_Parallel.c) : remplit blockOf et renvoie le nombre de
+// numros de blocs utiliss ; ils dpendent de l'ordonnancement, les
+// appelants les renumrotent
+uint32_t dfaParallelHopcroftBlocks(DfaMinimizer *d, uint32_t *blockOf);
+
+#endif
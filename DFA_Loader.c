@@ -0,0 +1,365 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+#define SCAN_BUFFER_SIZE (1u << 16)   // Bytes read per fread / Octets lus par fread
+#define SYMBOLIC_ALPHABET (1u << 16)  // Larger alphabets start as intervals / Au-del, alphabet en intervalles
+#define RANGE_CHUNK (1u << 16)        // Ranges applied per pass / Plages appliques par passe
+
+// Streaming tokenizer over a fixed buffer: the file is read once, in
+// order, and never held in memory as a whole.
+// Analyseur en flux sur un tampon fixe : le fichier est lu une seule fois,
+// dans l'ordre, sans jamais tre gard entier en mmoire.
+typedef struct {
+    FILE *in;
+    unsigned char *buffer;
+    size_t pos, len;
+    size_t line;       // Current line, from 1 / Ligne courante,  partir de 1
+    bool eof;
+} TextScanner;
+
+// Next byte without consuming it, refilling the buffer as needed
+// Octet suivant sans le consommer, en rechargeant le tampon si besoin
+static inline int scanPeek(TextScanner *sc) {
+    if (sc->pos == sc->len) {
+        if (sc->eof) return EOF;
+        sc->len = fread(sc->buffer, 1, SCAN_BUFFER_SIZE, sc->in);
+        sc->pos = 0;
+        if (sc->len == 0) {
+            sc->eof = true;
+            return EOF;
+        }
+    }
+    return sc->buffer[sc->pos];
+}
+
+// Skips blanks and a trailing comment, stopping at the end of the line
+// Saute les blancs et un commentaire final, en s'arrtant en fin de ligne
+static void skipBlanks(TextScanner *sc) {
+    for (;;) {
+        int c = scanPeek(sc);
+        if (c == ' ' || c == '\t' || c == '\r') {
+            sc->pos++;
+        } else if (c == '#') {
+            while ((c = scanPeek(sc)) != EOF && c != '\n') sc->pos++;
+        } else {
+            return;
+        }
+    }
+}
+
+// Skips blank and comment-only lines
+// Saute les lignes vides ou ne contenant qu'un commentaire
+static void skipEmptyLines(TextScanner *sc) {
+    for (;;) {
+        skipBlanks(sc);
+        if (scanPeek(sc) != '\n') return;
+        sc->pos++;
+        sc->line++;
+    }
+}
+
+// Consumes the end of the current line (or of the input); false if a token remains
+// Consomme la fin de la ligne courante (ou de l'entre) ; faux s'il reste un lment
+static bool scanEndOfLine(TextScanner *sc) {
+    skipBlanks(sc);
+    int c = scanPeek(sc);
+    if (c == EOF) return true;
+    if (c != '\n') return false;
+    sc->pos++;
+    sc->line++;
+    return true;
+}
+
+// Reads an unsigned decimal number that fits in 32 bits
+// Lit un nombre dcimal non sign tenant sur 32 bits
+static bool scanNumber(TextScanner *sc, uint32_t *value) {
+    skipBlanks(sc);
+    int c = scanPeek(sc);
+    if (c < '0' || c > '9') return false;
+    uint64_t v = 0;
+    for (;;) {
+        // Digits are consumed straight from the buffer, refilling only at its end
+        // Les chiffres sont lus directement dans le tampon, recharg seulement  sa fin
+        const unsigned char *p = sc->buffer + sc->pos, *end = sc->buffer + sc->len;
+        while (p < end && *p >= '0' && *p <= '9') {
+            v = v * 10 + (uint64_t)(*p++ - '0');
+            if (v > UINT32_MAX) return false;
+        }
+        sc->pos = (size_t)(p - sc->buffer);
+        if (p < end || scanPeek(sc) < '0' || scanPeek(sc) > '9') break;
+    }
+    *value = (uint32_t)v;
+    return true;
+}
+
+// Reads a decimal number with an optional '-' sign that fits in 32 bits
+// Lit un nombre dcimal  signe '-' facultatif tenant sur 32 bits
+static bool scanSigned(TextScanner *sc, int32_t *value) {
+    skipBlanks(sc);
+    bool negative = scanPeek(sc) == '-';
+    if (negative) sc->pos++;
+    uint32_t magnitude;
+    if (scanPeek(sc) < '0' || scanPeek(sc) > '9' || !scanNumber(sc, &magnitude)) return false;
+    if (magnitude > (negative ? (uint32_t)INT32_MAX + 1 : (uint32_t)INT32_MAX)) return false;
+    *value = negative ? (int32_t)(0 - (int64_t)magnitude) : (int32_t)magnitude;
+    return true;
+}
+
+// Reads the expected keyword at the start of the next non-empty line
+// Lit le mot-cl attendu au dbut de la prochaine ligne non vide
+static bool scanKeyword(TextScanner *sc, const char *keyword) {
+    skipEmptyLines(sc);
+    for (const char *k = keyword; *k; ++k) {
+        if (scanPeek(sc) != (unsigned char)*k) return false;
+        sc->pos++;
+    }
+    int c = scanPeek(sc);
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#' || c == EOF;
+}
+
+// Reads the expected keyword followed by a number
+// Lit le mot-cl attendu suivi d'un nombre
+static bool scanField(TextScanner *sc, const char *keyword, uint32_t *value) {
+    return scanKeyword(sc, keyword) && scanNumber(sc, value);
+}
+
+// Reads a symbol "sym" or an inclusive range "lo-hi" into [*lo, *hi]
+// Lit un symbole "sym" ou une plage inclusive "lo-hi" dans [*lo, *hi]
+static bool scanSymbols(TextScanner *sc, uint32_t *lo, uint32_t *hi) {
+    if (!scanNumber(sc, lo)) return false;
+    *hi = *lo;
+    if (scanPeek(sc) != '-') return true;
+    sc->pos++;
+    return scanPeek(sc) >= '0' && scanPeek(sc) <= '9' && scanNumber(sc, hi) && *hi >= *lo;
+}
+
+// Ranges read from a large-alphabet file and not yet applied, with the
+// line of each; at most RANGE_CHUNK of them
+// Plages lues dans un fichier  grand alphabet et pas encore appliques,
+// avec la ligne de chacune ; au plus RANGE_CHUNK
+typedef struct {
+    DfaRangeEdit *edits;
+    size_t *lines;
+    size_t count, capacity;
+    size_t chunks;     // Chunks applied so far / Lots dj appliqus
+} TransitionBuffer;
+
+// Applies the buffered ranges in one pass and empties the buffer. A range
+// conflicting with an earlier one, of this chunk or already in the table,
+// is reported on its own line.
+// Applique les plages en attente en une passe et vide le tampon. Une plage
+// en conflit avec une prcdente, de ce lot ou dj dans la table, est
+// signale sur sa propre ligne.
+static bool flushTransitions(DfaMinimizer *d, TransitionBuffer *b, TextScanner *sc) {
+    size_t conflict;
+    if (dfaSetTransitionRanges(d, b->edits, b->count, &conflict) != DFA_OK) {
+        if (conflict < b->count) sc->line = b->lines[conflict];
+        return false;
+    }
+    b->count = 0;
+    b->chunks++;
+    return true;
+}
+
+// Appends one range, doubling the arrays up to RANGE_CHUNK and applying
+// them when full
+// Ajoute une plage, en doublant les tableaux jusqu' RANGE_CHUNK et en les
+// appliquant quand ils sont pleins
+static bool bufferTransition(DfaMinimizer *d, TransitionBuffer *b, TextScanner *sc, DfaRangeEdit edit) {
+    if (b->count == RANGE_CHUNK && !flushTransitions(d, b, sc)) return false;
+    if (b->count == b->capacity) {
+        b->capacity = b->capacity ? 2 * b->capacity : 1024;
+        b->edits = xrealloc(b->edits, b->capacity, sizeof(DfaRangeEdit));
+        b->lines = xrealloc(b->lines, b->capacity, sizeof(size_t));
+    }
+    b->edits[b->count] = edit;
+    b->lines[b->count++] = sc->line;
+    return true;
+}
+
+// Parses the whole input into *out; values are checked before their line
+// ends, so that the scanner line is the faulty one on failure
+// Analyse toute l'entre dans *out ; les valeurs sont vrifies avant la fin
+// de leur ligne, la ligne de l'analyseur est donc la fautive en cas d'chec
+static DfaStatus parseText(TextScanner *sc, DfaMinimizer **out) {
+    uint32_t nStates, alphabetSize, initial;
+    if (!scanField(sc, "states", &nStates) || nStates == 0 || !scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+    if (!scanField(sc, "alphabet", &alphabetSize) || alphabetSize == 0 ||
+        alphabetSize > INT32_MAX || !scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+    if (!scanField(sc, "initial", &initial) || initial >= nStates || !scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+
+    // States are created in one block: no per-state allocation. Large
+    // alphabets are compressed first, so the table holds one column per
+    // class of the ranges read rather than one per symbol
+    // Les tats sont crs d'un bloc : aucune allocation par tat. Les grands
+    // alphabets sont d'abord compresss : la table a une colonne par classe
+    // des plages lues plutt qu'une par symbole
+    DfaMinimizer *d = dfaCreate(alphabetSize);
+    if (alphabetSize >= SYMBOLIC_ALPHABET) dfaCompressAlphabet(d);
+    if (dfaAddStates(d, nStates) == DFA_NO_STATE) {
+        dfaDestroy(d);
+        return DFA_ERR_FORMAT;
+    }
+    dfaSetInitial(d, initial);
+    *out = d;
+
+    // Final set: any number of ids on the "final" line
+    // Ensemble final : un nombre quelconque de numros sur la ligne "final"
+    if (!scanKeyword(sc, "final")) return DFA_ERR_FORMAT;
+    while (!scanEndOfLine(sc)) {
+        uint32_t s;
+        if (!scanNumber(sc, &s) || dfaSetFinal(d, s, true) != DFA_OK) return DFA_ERR_FORMAT;
+    }
+
+    // Optional "output state class" lines: transition lines start with a digit
+    // Lignes facultatives "output tat classe" : les transitions commencent par un chiffre
+    for (;;) {
+        skipEmptyLines(sc);
+        if (scanPeek(sc) != 'o') break;
+        uint32_t s;
+        int32_t output;
+        if (!scanField(sc, "output", &s) || !scanSigned(sc, &output) ||
+            dfaSetOutput(d, s, output) != DFA_OK || !scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+    }
+
+    // Transitions "source symbol target" or "source lo-hi target", straight
+    // into the table; a second, different target for the same (source,
+    // symbol) is rejected, checked once per interval of the range. Large
+    // alphabets buffer the ranges instead and apply them by chunks of
+    // RANGE_CHUNK, each pass cutting the boundaries and building the columns
+    // once, so memory stays bounded
+    // Transitions "source symbole cible" ou "source lo-hi cible", directement
+    // dans la table ; une seconde cible diffrente pour le mme (source,
+    // symbole) est refuse, vrifie une fois par intervalle de la plage. Les
+    // grands alphabets mettent plutt les plages en attente et les
+    // appliquent par lots de RANGE_CHUNK, chaque passe coupant les bornes et
+    // construisant les colonnes une seule fois : la mmoire reste borne
+    bool collect = alphabetSize >= SYMBOLIC_ALPHABET;
+    TransitionBuffer buffer = { 0 };
+    DfaStatus status = DFA_OK;
+    for (;;) {
+        skipEmptyLines(sc);
+        if (scanPeek(sc) == EOF) break;
+        uint32_t from, lo, hi, to;
+        status = DFA_ERR_FORMAT;
+        if (!scanNumber(sc, &from) || !scanSymbols(sc, &lo, &hi) || !scanNumber(sc, &to)) break;
+        if (from >= nStates || hi >= alphabetSize || to >= nStates) break;
+        if (collect) {
+            if (!bufferTransition(d, &buffer, sc, (DfaRangeEdit){ from, (int)lo, (int)hi, to })) break;
+        } else {
+            uint32_t sym = lo;
+            while (sym <= hi) {
+                uint32_t previous = dfaTransition(d, from, (int)sym);
+                if (previous != DFA_NO_STATE && previous != to) break;
+                sym = (uint32_t)dfaIntervalEnd(d, (int)sym) + 1;
+            }
+            if (sym <= hi || dfaSetTransitionRange(d, from, (int)lo, (int)hi, to) != DFA_OK) break;
+        }
+        if (!scanEndOfLine(sc)) break;
+        status = DFA_OK;
+    }
+
+    if (status == DFA_OK && !flushTransitions(d, &buffer, sc)) status = DFA_ERR_FORMAT;
+
+    // A later chunk may make columns split by an earlier one equal again:
+    // merging them gives the classes a single pass would
+    // Un lot ultrieur peut rendre gales des colonnes spares par un lot
+    // antrieur : les fusionner donne les classes d'une seule passe
+    if (status == DFA_OK && buffer.chunks > 1) dfaCompressAlphabet(d);
+    free(buffer.edits);
+    free(buffer.lines);
+    return status;
+}
+
+DfaStatus dfaLoadText(FILE *in, DfaMinimizer **out, size_t *errorLine) {
+    if (!in || !out) return DFA_ERR_INVALID;
+    *out = NULL;
+    TextScanner sc = { in, malloc(SCAN_BUFFER_SIZE), 0, 0, 1, false };
+    if (!sc.buffer) {
+        perror("malloc for scanner failed");
+        exit(EXIT_FAILURE);
+    }
+
+    DfaMinimizer *d = NULL;
+    DfaStatus status = parseText(&sc, &d);
+    if (ferror(in)) status = DFA_ERR_IO;
+    if (status != DFA_OK) {
+        if (status == DFA_ERR_FORMAT && errorLine) *errorLine = sc.line;
+        dfaDestroy(d);
+    } else {
+        *out = d;
+    }
+    free(sc.buffer);
+    return status;
+}
+
+// Parses an NFA: like parseText(), but "initial" lists one or more states,
+// there are no "output" lines and transitions are only appended, a range
+// as one edge per symbol
+// Analyse un automate non dterministe : comme parseText(), mais "initial"
+// liste un ou plusieurs tats, il n'y a pas de lignes "output" et les
+// transitions sont seulement ajoutes, une plage comme un arc par symbole
+static DfaStatus parseNfaText(TextScanner *sc, DfaNfa **out) {
+    uint32_t nStates, alphabetSize;
+    if (!scanField(sc, "states", &nStates) || nStates == 0 || !scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+    if (!scanField(sc, "alphabet", &alphabetSize) || alphabetSize == 0 ||
+        alphabetSize > INT32_MAX || !scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+
+    DfaNfa *nfa = dfaNfaCreate(alphabetSize);
+    if (dfaNfaAddStates(nfa, nStates) == DFA_NO_STATE) {
+        dfaNfaDestroy(nfa);
+        return DFA_ERR_FORMAT;
+    }
+    *out = nfa;
+
+    if (!scanKeyword(sc, "initial")) return DFA_ERR_FORMAT;
+    bool anyInitial = false;
+    while (!scanEndOfLine(sc)) {
+        uint32_t s;
+        if (!scanNumber(sc, &s) || dfaNfaSetInitial(nfa, s, true) != DFA_OK) return DFA_ERR_FORMAT;
+        anyInitial = true;
+    }
+    if (!anyInitial) return DFA_ERR_FORMAT;
+    if (!scanKeyword(sc, "final")) return DFA_ERR_FORMAT;
+    while (!scanEndOfLine(sc)) {
+        uint32_t s;
+        if (!scanNumber(sc, &s) || dfaNfaSetFinal(nfa, s, true) != DFA_OK) return DFA_ERR_FORMAT;
+    }
+
+    for (;;) {
+        skipEmptyLines(sc);
+        if (scanPeek(sc) == EOF) break;
+        uint32_t from, lo, hi, to;
+        if (!scanNumber(sc, &from) || !scanSymbols(sc, &lo, &hi) || !scanNumber(sc, &to)) return DFA_ERR_FORMAT;
+        if (from >= nStates || hi >= alphabetSize || to >= nStates) return DFA_ERR_FORMAT;
+        if (!scanEndOfLine(sc)) return DFA_ERR_FORMAT;
+        for (uint32_t sym = lo; sym <= hi; ++sym) dfaNfaAddTransition(nfa, from, (int)sym, to);
+    }
+    return DFA_OK;
+}
+
+DfaStatus dfaNfaLoadText(FILE *in, DfaNfa **out, size_t *errorLine) {
+    if (!in || !out) return DFA_ERR_INVALID;
+    *out = NULL;
+    TextScanner sc = { in, malloc(SCAN_BUFFER_SIZE), 0, 0, 1, false };
+    if (!sc.buffer) {
+        perror("malloc for scanner failed");
+        exit(EXIT_FAILURE);
+    }
+
+    DfaNfa *nfa = NULL;
+    DfaStatus status = parseNfaText(&sc, &nfa);
+    if (ferror(in)) status = DFA_ERR_IO;
+    if (status != DFA_OK) {
+        if (status == DFA_ERR_FORMAT && errorLine) *errorLine = sc.line;
+        dfaNfaDestroy(nfa);
+    } else {
+        *out = nfa;
+    }
+    free(sc.buffer);
+    return status;
+}
@@ -4,416 +4,485 @@ By Ed-dahmani Soulaimane
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/types.h>
 
-#define MAX_STATES 64
-#define ALPHABET_SIZE 2  // Binary alphabet (0/1 or a/b)
-#define MAX_LABEL_LEN 512
-
-// Structure representing a DFA state
-// Structure reprsentant un tat d'automate
-typedef struct State {
-    char  name[4];       // State name (3 chars max)
-    bool  isFinal;       // Is this a final/accepting state?
-    struct State *next[ALPHABET_SIZE];  // Transitions for each alphabet symbol
-    int   id;            // Unique state ID
-    int   partitionId;   // Current partition ID during minimization
-} State;
-
-// Global array tracking all states in the DFA
-// Tableau global pour suivre tous les tats de l'automate
-static State *allStates[MAX_STATES];
-static int    nStates = 0;  // Current number of states
-
-// Structure representing a partition of states
-// Structure reprsentant une partition d'tats
-typedef struct {
-    State* states[MAX_STATES]; // States in this partition
-    int    count;              // Number of states
-    int    id;                 // Partition ID
-    char   label[MAX_LABEL_LEN]; // Display label
-} Partition;
-
-static Partition partitions[MAX_STATES];
-static int       nPartitions = 0;  // Current partition count
-
-// Helper function to find state index by pointer
-// Fonction utilitaire pour trouver l'index d'un tat par son pointeur
-static int getStateIndexByPtr(State *s) {
-    if (!s) return -1;
-    for (int i = 0; i < nStates; ++i) {
-        if (allStates[i] == s) return i;
-    }
-    return -1;
+#include "DFA_Minimizer.h"
+
+#define PRINT_SYMBOLS_MAX 256   // Wider alphabets print per interval / Au-del, affichage par intervalle
+
+// Display name of a state: its own name, or "q<id>" for unnamed (loaded) states
+// Nom affich d'un tat : son nom, ou "q<numro>" pour les tats anonymes (chargs)
+static const char *stateLabel(const DfaMinimizer *dfa, uint32_t s, char buffer[16]) {
+    const char *name = dfaStateName(dfa, s);
+    if (name && name[0]) return name;
+    snprintf(buffer, 16, "q%u", s);
+    return buffer;
 }
 
-// Creates a new state and adds it to global array
-// Cre un nouvel tat et l'ajoute au tableau global
-static State *createState(const char *name, bool isFinal) {
-    if (nStates >= MAX_STATES) {
-        fprintf(stderr, "Error: MAX_STATES exceeded\n");
+// Builds the display label "{q1,q2,...}" of a partition (caller frees)
+// Construit le libell "{q1,q2,...}" d'une partition ( librer par l'appelant)
+static char *partitionLabel(const DfaMinimizer *dfa, int partition) {
+    char buffer[16];
+    uint32_t count;
+    const uint32_t *states = dfaPartitionStates(dfa, partition, &count);
+    size_t len = 3;
+    for (uint32_t j = 0; j < count; ++j) len += strlen(stateLabel(dfa, states[j], buffer)) + 1;
+    char *label = malloc(len);
+    if (!label) {
+        perror("malloc for label failed");
         exit(EXIT_FAILURE);
     }
-    State *s = malloc(sizeof(State));
-    if (!s) {
-        perror("malloc for State failed");
-        exit(EXIT_FAILURE);
+    char *out = label;
+    *out++ = '{';
+    for (uint32_t j = 0; j < count; ++j) {
+        const char *name = stateLabel(dfa, states[j], buffer);
+        size_t nameLen = strlen(name);
+        memcpy(out, name, nameLen);
+        out += nameLen;
+        if (j < count - 1) *out++ = ',';
     }
-    snprintf(s->name, sizeof(s->name), "%s", name);
-    s->isFinal = isFinal;
-    s->next[0] = s->next[1] = NULL;
-    s->id = nStates;
-    s->partitionId = -1;
-    allStates[nStates++] = s;
-    return s;
+    *out++ = '}';
+    *out = '\0';
+    return label;
 }
 
-// Array to track reachable states during cleanup
-// Tableau pour suivre les tats accessibles pendant le nettoyage
-static bool reachable[MAX_STATES];
+// Partition id reached from state s on symbol sym (-2 if no transition)
+// Partition atteinte depuis l'tat s par le symbole sym (-2 sans transition)
+static int32_t nextPartition(const DfaMinimizer *dfa, uint32_t s, int sym) {
+    uint32_t t = dfaTransition(dfa, s, sym);
+    return t == DFA_NO_STATE ? -2 : dfaPartitionOf(dfa, t);
+}
 
-// Marks all states reachable from startNode using BFS
-// Marque tous les tats accessibles depuis startNode en utilisant BFS
-static void markReachable(State *startNode) {
-    if (!startNode) return;
+// Column header of symbols sym..last: letters for small alphabets, numbers otherwise
+// En-tte de colonne des symboles sym..last : lettres pour les petits alphabets, sinon numros
+static void symbolHeader(char *out, size_t size, uint32_t sym, uint32_t last, uint32_t k) {
+    if (k <= 26) snprintf(out, size, "Next on '%c'", 'a' + (int)sym);
+    else if (last > sym) snprintf(out, size, "Next on %u-%u", sym, last);
+    else snprintf(out, size, "Next on %u", sym);
+}
 
-    // Initialize all states as unreachable
-    // Initialise tous les tats comme inaccessibles
-    for (int i = 0; i < nStates; ++i) {
-        reachable[i] = false;
-    }
+// Last symbol of the column starting at sym: large compressed alphabets
+// print one column per interval, the others one per symbol
+// Dernier symbole de la colonne commenant en sym : les grands alphabets
+// compresss ont une colonne par intervalle, les autres une par symbole
+static uint32_t columnEnd(const DfaMinimizer *dfa, uint32_t sym) {
+    return dfaAlphabetSize(dfa) > PRINT_SYMBOLS_MAX ? (uint32_t)dfaIntervalEnd(dfa, (int)sym) : sym;
+}
 
-    int startIndex = getStateIndexByPtr(startNode);
-    if (startIndex == -1) {
-         if (nStates > 0 && allStates[0] == startNode) startIndex = 0;
-         else {
-            fprintf(stderr, "Error: Start node not found in allStates during markReachable.\n");
-            return;
-         }
+// Prints the minimized DFA transition table
+// Affiche la table de transition de l'automate minimis
+static void printMinimizedDFA(const DfaMinimizer *dfa) {
+    uint32_t k = dfaAlphabetSize(dfa);
+    printf("\nMinimized DFA Transition Table:\n");
+    printf("%-25s", "State (Original States)");
+    uint32_t nColumns = 0;
+    for (uint32_t sym = 0; sym < k; sym = columnEnd(dfa, sym) + 1, ++nColumns) {
+        char header[32];
+        symbolHeader(header, sizeof(header), sym, columnEnd(dfa, sym), k);
+        printf("| %-15s", header);
     }
-    reachable[startIndex] = true;
-
-    // Propagate reachability through transitions
-    // Propage l'accessibilit  travers les transitions
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (int i = 0; i < nStates; ++i) {
-            if (!reachable[i]) continue;
-
-            for (int sym = 0; sym < ALPHABET_SIZE; ++sym) {
-                State *targetState = allStates[i]->next[sym];
-                if (targetState) {
-                    int targetIndex = getStateIndexByPtr(targetState);
-                    if (targetIndex != -1 && !reachable[targetIndex]) {
-                        reachable[targetIndex] = true;
-                        changed = true;
-                    }
-                }
+    printf("\n");
+    for (uint32_t i = 0; i < 32 + 17 * nColumns; ++i) putchar('-');
+    printf("\n");
+
+    for (int i = 0; i < dfaPartitionCount(dfa); ++i) {
+        uint32_t count;
+        const uint32_t *states = dfaPartitionStates(dfa, i, &count);
+        if (count == 0) continue;
+
+        uint32_t representative = states[0];
+        char *label = partitionLabel(dfa, i);
+        size_t labelSize = strlen(label) + 16;
+        char *currentLabelWithName = malloc(labelSize);
+        if (!currentLabelWithName) {
+            perror("malloc for label failed");
+            exit(EXIT_FAILURE);
+        }
+        bool isNewStateFinal = dfaIsFinal(dfa, representative);
+
+        snprintf(currentLabelWithName, labelSize, "S%d %s%c",
+                 i, label, (isNewStateFinal ? '*' : ' '));
+        free(label);
+
+        // One column per symbol (or interval)
+        // Une colonne par symbole (ou intervalle)
+        printf("%-25s", currentLabelWithName);
+        for (uint32_t sym = 0; sym < k; sym = columnEnd(dfa, sym) + 1) {
+            char nextStateLabel[20] = "-";
+            int32_t targetPartitionId = nextPartition(dfa, representative, (int)sym);
+            if (targetPartitionId >= 0) {
+                snprintf(nextStateLabel, sizeof(nextStateLabel), "S%d", targetPartitionId);
             }
+            printf("| %-15s", nextStateLabel);
         }
+        printf("\n");
+        free(currentLabelWithName);
     }
+    printf("(* indicates final state in minimized DFA)\n");
 }
 
-// Removes unreachable states from the DFA
-// Supprime les tats inaccessibles de l'automate
-static void removeUnreachable(State *startNode) {
-    markReachable(startNode);
-
-    // Clear transitions to unreachable states
-    // Nettoie les transitions vers les tats inaccessibles
-    for (int i = 0; i < nStates; ++i) {
-        if (reachable[i]) {
-            for (int sym = 0; sym < ALPHABET_SIZE; ++sym) {
-                State *targetState = allStates[i]->next[sym];
-                if (targetState) {
-                    int targetIndex = getStateIndexByPtr(targetState);
-                    if (targetIndex != -1 && !reachable[targetIndex]) {
-                        allStates[i]->next[sym] = NULL;
-                    }
-                }
-            }
-        }
-    }
+// Example DFA 1 (six states); returns its initial state
+// Exemple d'automate 1 (six tats) ; renvoie son tat initial
+static uint32_t buildExample1(DfaMinimizer *dfa) {
+    uint32_t q0 = dfaAddState(dfa, "q0", false);
+    uint32_t q1 = dfaAddState(dfa, "q1", true);
+    uint32_t q2 = dfaAddState(dfa, "q2", true);
+    uint32_t q3 = dfaAddState(dfa, "q3", false);
+    uint32_t q4 = dfaAddState(dfa, "q4", true);
+    uint32_t q5 = dfaAddState(dfa, "q5", false);
+
+    dfaSetTransition(dfa, q0, 0, q3); dfaSetTransition(dfa, q0, 1, q1);
+    dfaSetTransition(dfa, q1, 0, q2); dfaSetTransition(dfa, q1, 1, q5);
+    dfaSetTransition(dfa, q2, 0, q2); dfaSetTransition(dfa, q2, 1, q5);
+    dfaSetTransition(dfa, q3, 0, q0); dfaSetTransition(dfa, q3, 1, q4);
+    dfaSetTransition(dfa, q4, 0, q2); dfaSetTransition(dfa, q4, 1, q5);
+    dfaSetTransition(dfa, q5, 0, q5); dfaSetTransition(dfa, q5, 1, q5);
+    dfaSetInitial(dfa, q0);
+    return q0;
+}
 
-    // Compact the states array, removing unreachable states
-    // Compacte le tableau d'tats, supprimant les inaccessibles
-    int writeIndex = 0;
-    for (int readIndex = 0; readIndex < nStates; ++readIndex) {
-        if (reachable[readIndex]) {
-            if (readIndex != writeIndex) {
-                allStates[writeIndex] = allStates[readIndex];
-            }
-            allStates[writeIndex]->id = writeIndex;
-            writeIndex++;
-        } else {
-            free(allStates[readIndex]);
-            allStates[readIndex] = NULL;
-        }
-    }
-    nStates = writeIndex;
+// Example DFA 2 (four states, q4 unreachable); returns its initial state
+// Exemple d'automate 2 (quatre tats, q4 inaccessible) ; renvoie son tat initial
+static uint32_t buildExample2(DfaMinimizer *dfa) {
+    uint32_t q1 = dfaAddState(dfa, "q1", false);
+    uint32_t q2 = dfaAddState(dfa, "q2", true);
+    uint32_t q3 = dfaAddState(dfa, "q3", true);
+    uint32_t q4 = dfaAddState(dfa, "q4", false);
+
+    dfaSetTransition(dfa, q1, 0, q2); dfaSetTransition(dfa, q1, 1, q3);
+    dfaSetTransition(dfa, q2, 0, q3); dfaSetTransition(dfa, q2, 1, q2);
+    dfaSetTransition(dfa, q3, 0, q3); dfaSetTransition(dfa, q3, 1, q2);
+    dfaSetTransition(dfa, q4, 0, q2); dfaSetTransition(dfa, q4, 1, q3);
+    dfaSetInitial(dfa, q1);
+    return q1;
 }
 
-// Creates initial partitions (final vs non-final states)
-// Cre les partitions initiales (tats finaux vs non finaux)
-static void initialPartition(void) {
-    nPartitions = 0;
-    Partition finalP;
-    Partition nonFinalP;
-    finalP.count = 0; finalP.id = -1; finalP.label[0] = '\0';
-    nonFinalP.count = 0; nonFinalP.id = -1; nonFinalP.label[0] = '\0';
-
-    // Separate final and non-final states
-    // Spare les tats finaux et non finaux
-    for (int i = 0; i < nStates; ++i) {
-        allStates[i]->partitionId = -1;
-        if (allStates[i]->isFinal) {
-            finalP.states[finalP.count++] = allStates[i];
-        } else {
-            nonFinalP.states[nonFinalP.count++] = allStates[i];
-        }
+// Loads a binary (mapped) or text-format DFA, reporting errors on stderr
+// (NULL on failure)
+// Charge un automate binaire (projet) ou au format texte, erreurs sur
+// stderr (NULL en cas d'chec)
+static DfaMinimizer *loadFile(const char *path) {
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return NULL;
     }
+    DfaMinimizer *dfa = NULL;
+    size_t line = 0;
+    DfaStatus status;
+    char magic[sizeof(DFA_BINARY_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), in) == sizeof(magic) &&
+        memcmp(magic, DFA_BINARY_MAGIC, sizeof(magic)) == 0) {
+        fclose(in);
+        status = dfaLoadBinary(path, &dfa);
+    } else {
+        rewind(in);
+        status = dfaLoadText(in, &dfa, &line);
+        fclose(in);
+    }
+    if (status == DFA_ERR_FORMAT && line) fprintf(stderr, "%s:%zu: malformed DFA\n", path, line);
+    else if (status == DFA_ERR_FORMAT) fprintf(stderr, "%s: malformed DFA\n", path);
+    else if (status != DFA_OK) fprintf(stderr, "%s: read error\n", path);
+    return dfa;
+}
 
-    // Create partition for final states if any exist
-    // Cre une partition pour les tats finaux s'il y en a
-    if (finalP.count > 0) {
-        finalP.id = nPartitions;
-        strcpy(finalP.label, "{");
-        for (int i = 0; i < finalP.count; ++i) {
-            finalP.states[i]->partitionId = finalP.id;
-            strcat(finalP.label, finalP.states[i]->name);
-            if (i < finalP.count - 1) strcat(finalP.label, ",");
-        }
-        strcat(finalP.label, "}");
-        partitions[nPartitions++] = finalP;
+// Loads a text-format NFA, reduces it by bisimulation and determinizes it
+// by double reversal, errors on stderr (NULL on failure)
+// Charge un automate non dterministe au format texte, le rduit par
+// bisimulation et le dterminise par double renversement, erreurs sur
+// stderr (NULL en cas d'chec)
+static DfaMinimizer *loadNfaFile(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return NULL;
     }
+    DfaNfa *nfa = NULL;
+    size_t line = 0;
+    DfaStatus status = dfaNfaLoadText(in, &nfa, &line);
+    fclose(in);
+    if (status == DFA_ERR_FORMAT && line) fprintf(stderr, "%s:%zu: malformed NFA\n", path, line);
+    else if (status == DFA_ERR_FORMAT) fprintf(stderr, "%s: malformed NFA\n", path);
+    else if (status != DFA_OK) fprintf(stderr, "%s: read error\n", path);
+    if (status != DFA_OK) return NULL;
+    DfaNfa *reduced = dfaNfaBisimulation(nfa);
+    printf("NFA with %u states reduced by bisimulation: %u states\n", dfaNfaStateCount(nfa), dfaNfaStateCount(reduced));
+    DfaMinimizer *dfa = dfaBrzozowski(reduced);
+    printf("NFA with %u states minimized by double reversal: %u states\n", dfaNfaStateCount(reduced), dfaStateCount(dfa));
+    dfaNfaDestroy(reduced);
+    dfaNfaDestroy(nfa);
+    return dfa;
+}
 
-    // Create partition for non-final states if any exist
-    // Cre une partition pour les tats non finaux s'il y en a
-    if (nonFinalP.count > 0) {
-        nonFinalP.id = nPartitions;
-        strcpy(nonFinalP.label, "{");
-        for (int i = 0; i < nonFinalP.count; ++i) {
-            nonFinalP.states[i]->partitionId = nonFinalP.id;
-            strcat(nonFinalP.label, nonFinalP.states[i]->name);
-            if (i < nonFinalP.count - 1) strcat(nonFinalP.label, ",");
+// Builds the minimal DFA of a sorted word list (one word per line, bytes
+// as symbols) incrementally, errors on stderr (NULL on failure)
+// Construit de faon incrmentale l'automate minimal d'une liste de mots
+// trie (un mot par ligne, octets comme symboles), erreurs sur stderr
+// (NULL en cas d'chec)
+static DfaMinimizer *loadWordList(const char *path) {
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return NULL;
+    }
+    DfaDawgBuilder *builder = dfaDawgCreate(256);
+    char *line = NULL;
+    size_t lineCapacity = 0, symbolsCapacity = 0, lineNumber = 0;
+    int *symbols = NULL;
+    ssize_t length;
+    DfaStatus status = DFA_OK;
+    while (status == DFA_OK && (length = getline(&line, &lineCapacity, in)) >= 0) {
+        lineNumber++;
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) length--;
+        if ((size_t)length > symbolsCapacity) {
+            symbolsCapacity = (size_t)length * 2;
+            symbols = realloc(symbols, symbolsCapacity * sizeof(int));
+            if (!symbols) {
+                perror("malloc for word failed");
+                exit(EXIT_FAILURE);
+            }
         }
-        strcat(nonFinalP.label, "}");
-        partitions[nPartitions++] = nonFinalP;
+        for (ssize_t i = 0; i < length; ++i) symbols[i] = (unsigned char)line[i];
+        status = dfaDawgAddWord(builder, symbols, (size_t)length);
     }
-
-    printf("Initial Partitions (%d):\n", nPartitions);
-    for (int i = 0; i < nPartitions; ++i) {
-        printf("  Partition %d %s\n", partitions[i].id, partitions[i].label);
+    bool readError = ferror(in);
+    fclose(in);
+    free(symbols);
+    free(line);
+
+    DfaMinimizer *dfa = NULL;
+    if (status != DFA_OK) fprintf(stderr, "%s:%zu: word out of order\n", path, lineNumber);
+    else if (readError) fprintf(stderr, "%s: read error\n", path);
+    else {
+        dfa = dfaDawgFinish(builder);
+        printf("Word list with %zu words built incrementally: %u states\n", dfaDawgWordCount(builder), dfaStateCount(dfa));
     }
+    dfaDawgDestroy(builder);
+    return dfa;
 }
 
-// Refines partitions until no more splits are possible
-// Raffine les partitions jusqu' ce qu'aucune division ne soit possible
-static void refineAllPartitions(void) {
-    bool changedInPass;
-    do {
-        changedInPass = false;
-        Partition newPartitionsList[MAX_STATES];
-        int newNPartitionsCounter = 0;
-
-        // Process each existing partition
-        // Traite chaque partition existante
-        for (int i = 0; i < nPartitions; ++i) {
-            Partition *P = &partitions[i];
-            if (P->count <= 1) {
-                if (P->count > 0 && newNPartitionsCounter < MAX_STATES) {
-                     newPartitionsList[newNPartitionsCounter++] = *P;
-                }
-                continue;
-            }
-
-            Partition subPartitions[MAX_STATES];
-            int nSubPartitions = 0;
-
-            // Start with first state in its own subpartition
-            // Commence avec le premier tat dans sa propre sous-partition
-            subPartitions[0].count = 0;
-            subPartitions[0].states[subPartitions[0].count++] = P->states[0];
-            nSubPartitions = 1;
-
-            // Compare each state with existing subpartitions
-            // Compare chaque tat avec les sous-partitions existantes
-            for (int j = 1; j < P->count; ++j) {
-                State *s_j = P->states[j];
-                bool placed = false;
-
-                for (int k = 0; k < nSubPartitions; ++k) {
-                    State *s_k_rep = subPartitions[k].states[0];
-                    bool distinguishable = false;
-
-                    // Check if states lead to different partitions
-                    // Vrifie si les tats mnent  des partitions diffrentes
-                    for (int sym = 0; sym < ALPHABET_SIZE; ++sym) {
-                        State *next_s_j = s_j->next[sym];
-                        State *next_s_k_rep = s_k_rep->next[sym];
-
-                        int p_id_next_s_j = next_s_j ? next_s_j->partitionId : -2;
-                        int p_id_next_s_k_rep = next_s_k_rep ? next_s_k_rep->partitionId : -2;
-
-                        if (p_id_next_s_j != p_id_next_s_k_rep) {
-                            distinguishable = true;
-                            break;
-                        }
-                    }
-
-                    if (!distinguishable) {
-                        subPartitions[k].states[subPartitions[k].count++] = s_j;
-                        placed = true;
-                        break;
-                    }
-                }
-
-                if (!placed) {
-                    if (nSubPartitions >= MAX_STATES) { }
-                    subPartitions[nSubPartitions].count = 0;
-                    subPartitions[nSubPartitions].states[subPartitions[nSubPartitions].count++] = s_j;
-                    nSubPartitions++;
-                }
-            }
+// Writes the minimized DFA of a refined context in the binary format
+// crit l'automate minimis d'un contexte raffin au format binaire
+static bool saveMinimized(const DfaMinimizer *dfa, const char *path) {
+    DfaMinimizer *minimized = dfaQuotient(dfa);
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        dfaDestroy(minimized);
+        return false;
+    }
+    DfaStatus status = minimized ? dfaSaveBinary(minimized, out) : DFA_ERR_INVALID;
+    if (fclose(out) != 0 && status == DFA_OK) status = DFA_ERR_IO;
+    dfaDestroy(minimized);
+    if (status != DFA_OK) fprintf(stderr, "%s: write error\n", path);
+    return status == DFA_OK;
+}
 
-            // Add all subpartitions to the new partition list
-            // Ajoute toutes les sous-partitions  la nouvelle liste de partitions
-            for (int k = 0; k < nSubPartitions; ++k) {
-                if (newNPartitionsCounter < MAX_STATES) {
-                    newPartitionsList[newNPartitionsCounter++] = subPartitions[k];
-                }
-            }
+// Batch mode: minimizes count DFAs concurrently and prints one line per DFA,
+// either loaded from files or alternating the two built-in examples
+// Mode lot : minimise count automates en parallle, une ligne par automate,
+// chargs depuis des fichiers ou alternant les deux exemples intgrs
+static int runBatch(size_t count, char **files, DfaEngine engine, bool dropDead, int nThreads) {
+    DfaMinimizer **dfas = calloc(count ? count : 1, sizeof(DfaMinimizer *));
+    DfaBatchResult *results = malloc(sizeof(DfaBatchResult) * (count ? count : 1));
+    uint32_t *originalStates = malloc(sizeof(uint32_t) * (count ? count : 1));
+    if (!dfas || !results || !originalStates) {
+        perror("malloc for batch failed");
+        return EXIT_FAILURE;
+    }
 
-            if (nSubPartitions > 1) {
-                changedInPass = true;
-            }
+    bool loaded = true;
+    for (size_t i = 0; i < count && loaded; ++i) {
+        if (files) {
+            dfas[i] = loadFile(files[i]);
+            loaded = dfas[i] != NULL;
+        } else {
+            dfas[i] = dfaCreate(2);
+            if (i % 2 == 0) buildExample1(dfas[i]);
+            else buildExample2(dfas[i]);
         }
+        if (loaded) originalStates[i] = dfaStateCount(dfas[i]);
+    }
 
-        // Update partitions if changes were made
-        // Met  jour les partitions si des changements ont t faits
-        if (changedInPass || newNPartitionsCounter != nPartitions) {
-            nPartitions = newNPartitionsCounter;
-            for (int i = 0; i < nPartitions; ++i) {
-                partitions[i] = newPartitionsList[i];
-                partitions[i].id = i;
-
-                // Update labels and partition IDs
-                // Met  jour les libells et IDs de partition
-                partitions[i].label[0] = '\0';
-                strcat(partitions[i].label, "{");
-                for (int j = 0; j < partitions[i].count; ++j) {
-                    partitions[i].states[j]->partitionId = partitions[i].id;
-                    strcat(partitions[i].label, partitions[i].states[j]->name);
-                    if (j < partitions[i].count - 1) strcat(partitions[i].label, ",");
-                }
-                strcat(partitions[i].label, "}");
-            }
-             printf("Partitions refined (%d total):\n", nPartitions);
-             for (int i = 0; i < nPartitions; ++i) {
-                 printf("  Partition %d %s\n", partitions[i].id, partitions[i].label);
-             }
+    DfaStatus status = loaded ? dfaMinimizeBatch(dfas, count, engine, dropDead, nThreads, results)
+                              : DFA_ERR_INVALID;
+    for (size_t i = 0; status == DFA_OK && i < count; ++i) {
+        char name[32];
+        if (files) snprintf(name, sizeof(name), "%s", files[i]);
+        else snprintf(name, sizeof(name), "DFA %zu", i);
+        if (results[i].status == DFA_OK) {
+            printf("%s: %u states -> %d states\n", name, originalStates[i], results[i].partitionCount);
         } else {
-            changedInPass = false;
+            printf("%s: error %d\n", name, (int)results[i].status);
         }
+    }
 
-    } while (changedInPass);
+    for (size_t i = 0; i < count; ++i) dfaDestroy(dfas[i]);
+    free(originalStates);
+    free(results);
+    free(dfas);
+    return status == DFA_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    printf("\nFinal Partitions after refinement (%d):\n", nPartitions);
-    for (int i = 0; i < nPartitions; ++i) {
-        printf("  Partition %d (New State S%d) %s\n", partitions[i].id, partitions[i].id, partitions[i].label);
+// Equivalence mode: checks that two DFA files accept the same language and
+// prints a shortest distinguishing word otherwise
+// Mode quivalence : vrifie que deux fichiers d'automates acceptent le mme
+// langage, et affiche sinon un mot distinguant le plus court
+static int runEquivalence(const char *pathA, const char *pathB) {
+    DfaMinimizer *a = loadFile(pathA);
+    DfaMinimizer *b = a ? loadFile(pathB) : NULL;
+    bool equal = false;
+    int *word = NULL;
+    size_t length = 0;
+    DfaStatus status = b ? dfaEquivalent(a, b, &equal, &word, &length) : DFA_ERR_INVALID;
+    if (status == DFA_OK && equal) {
+        printf("%s and %s are equivalent\n", pathA, pathB);
+    } else if (status == DFA_OK) {
+        printf("%s and %s differ on the word:", pathA, pathB);
+        if (length == 0) printf(" (empty)");
+        for (size_t i = 0; i < length; ++i) printf(" %d", word[i]);
+        printf("\n");
+    } else if (b) {
+        fprintf(stderr, "%s, %s: alphabet sizes differ\n", pathA, pathB);
     }
+    free(word);
+    dfaDestroy(b);
+    dfaDestroy(a);
+    return status == DFA_OK && equal ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
-// Prints the minimized DFA transition table
-// Affiche la table de transition de l'automate minimis
-static void printMinimizedDFA(void) {
-    printf("\nMinimized DFA Transition Table:\n");
-    printf("%-25s| %-15s| %-15s\n", "State (Original States)", "Next on 'a'", "Next on 'b'");
-    printf("------------------------------------------------------------------\n");
-
-    for (int i = 0; i < nPartitions; ++i) {
-        Partition *currentP = &partitions[i];
-        if (currentP->count == 0) continue;
-
-        State *representative = currentP->states[0];
-        char currentLabelWithName[MAX_LABEL_LEN + 5];
-        bool isNewStateFinal = representative->isFinal;
-
-        snprintf(currentLabelWithName, sizeof(currentLabelWithName), "S%d %s%c",
-                 currentP->id, currentP->label, (isNewStateFinal ? '*' : ' '));
-
-        char nextStateLabelA[20] = "-";
-        char nextStateLabelB[20] = "-";
-
-        if (representative->next[0]) {
-            int targetPartitionIdA = representative->next[0]->partitionId;
-            snprintf(nextStateLabelA, sizeof(nextStateLabelA), "S%d", targetPartitionIdA);
-        }
+// Prints command line usage
+// Affiche l'utilisation en ligne de commande
+static void printUsage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-e moore|hopcroft|signature|radix|parallel|phopcroft|brzozowski|revuz] [-n | -w | -q] [-d] [-c] [-B count] [-j threads] [-o out.bin] [file...]\n", prog);
+}
 
-        if (representative->next[1]) {
-            int targetPartitionIdB = representative->next[1]->partitionId;
-            snprintf(nextStateLabelB, sizeof(nextStateLabelB), "S%d", targetPartitionIdB);
+int main(int argc, char **argv) {
+    // Refinement engine, one of DfaEngine: Moore (default), Hopcroft, Moore by
+    // hashed or sorted signatures, parallel Moore or Hopcroft, Brzozowski or Revuz
+    // Moteur de raffinement, parmi DfaEngine : Moore (dfaut), Hopcroft, Moore
+    // par signatures haches ou tries, Moore ou Hopcroft parallle, Brzozowski ou Revuz
+    DfaEngine engine = DFA_ENGINE_MOORE;
+    bool nfaInput = false;  // -n: the file is an NFA / le fichier est non dterministe
+    bool wordInput = false; // -w: the file is a sorted word list / le fichier est une liste de mots trie
+    bool equivalence = false;   // -q: compare two files / compare deux fichiers
+    bool dropDead = false;  // -d: also remove dead states / supprime aussi les tats morts
+    bool compress = false;  // -c: merge equivalent symbols / fusionne les symboles quivalents
+    long batchCount = 0;    // -B: batch size / taille du lot
+    int nThreads = 0;       // -j: batch or parallel engine threads, 0 = all CPUs / threads, 0 = tous les processeurs
+    const char *outputPath = NULL;  // -o: binary output / sortie binaire
+    char **files = calloc((size_t)argc, sizeof(char *));  // Text-format DFAs / Automates au format texte
+    size_t nFiles = 0;
+    if (!files) {
+        perror("malloc for arguments failed");
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (strcmp(name, "hopcroft") == 0) engine = DFA_ENGINE_HOPCROFT;
+            else if (strcmp(name, "moore") == 0) engine = DFA_ENGINE_MOORE;
+            else if (strcmp(name, "signature") == 0) engine = DFA_ENGINE_SIGNATURE;
+            else if (strcmp(name, "radix") == 0) engine = DFA_ENGINE_RADIX;
+            else if (strcmp(name, "parallel") == 0) engine = DFA_ENGINE_PARALLEL_MOORE;
+            else if (strcmp(name, "phopcroft") == 0) engine = DFA_ENGINE_PARALLEL_HOPCROFT;
+            else if (strcmp(name, "brzozowski") == 0) engine = DFA_ENGINE_BRZOZOWSKI;
+            else if (strcmp(name, "revuz") == 0) engine = DFA_ENGINE_REVUZ;
+            else { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-n") == 0) {
+            nfaInput = true;
+        } else if (strcmp(argv[i], "-w") == 0) {
+            wordInput = true;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            equivalence = true;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            dropDead = true;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            compress = true;
+        } else if (strcmp(argv[i], "-B") == 0 && i + 1 < argc) {
+            batchCount = strtol(argv[++i], NULL, 10);
+            if (batchCount <= 0) { printUsage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nThreads = (int)strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (argv[i][0] != '-') {
+            files[nFiles++] = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
         }
+    }
 
-        printf("%-25s| %-15s| %-15s\n",
-               currentLabelWithName, nextStateLabelA, nextStateLabelB);
+    // Several files, or -B without files, run in batch mode
+    // Plusieurs fichiers, ou -B sans fichier, passent en mode lot
+    if ((nfaInput || wordInput) && (nFiles != 1 || (nfaInput && wordInput))) {
+        printUsage(argv[0]);
+        free(files);
+        return EXIT_FAILURE;
+    }
+    if (equivalence) {
+        int result = nFiles == 2 && !nfaInput && !wordInput ? runEquivalence(files[0], files[1]) : EXIT_FAILURE;
+        if (nFiles != 2 || nfaInput || wordInput) printUsage(argv[0]);
+        free(files);
+        return result;
+    }
+    if (nFiles > 1 || (batchCount > 0 && nFiles == 0)) {
+        int result = nFiles > 1 ? runBatch(nFiles, files, engine, dropDead, nThreads)
+                                : runBatch((size_t)batchCount, NULL, engine, dropDead, nThreads);
+        free(files);
+        return result;
     }
-    printf("(* indicates final state in minimized DFA)\n");
-}
 
-int main(void) {
-    /* Example DFA 1:
-    State *q0 = createState("q0", false);
-    State *q1 = createState("q1", true);
-    State *q2 = createState("q2", true);
-    State *q3 = createState("q3", false);
-    State *q4 = createState("q4", true);
-    State *q5 = createState("q5", false);
-
-    State *initialDFAState = q0;
-
-    q0->next[0] = q3; q0->next[1] = q1;
-    q1->next[0] = q2; q1->next[1] = q5;
-    q2->next[0] = q2; q2->next[1] = q5;
-    q3->next[0] = q0; q3->next[1] = q4;
-    q4->next[0] = q2; q4->next[1] = q5;
-    q5->next[0] = q5; q5->next[1] = q5;
-    */
-
-    // Example DFA 2
-    // Exemple d'automate 2
-    State *q1 = createState("q1", false);
-    State *q2 = createState("q2", true);
-    State *q3 = createState("q3", true);
-    State *q4 = createState("q4", false);
-
-    State *initialDFAState = q1;
-
-    q1->next[0] = q2; q1->next[1] = q3;
-    q2->next[0] = q3; q2->next[1] = q2;
-    q3->next[0] = q3; q3->next[1] = q2;
-    q4->next[0] = q2; q4->next[1] = q3;
-
-    printf("Original DFA defined. Initial state: %s. Number of states: %d\n", initialDFAState->name, nStates);
+    DfaMinimizer *dfa;
+    if (nFiles == 1) {
+        dfa = nfaInput ? loadNfaFile(files[0]) : wordInput ? loadWordList(files[0]) : loadFile(files[0]);
+        if (!dfa) {
+            free(files);
+            return EXIT_FAILURE;
+        }
+    } else {
+        dfa = dfaCreate(2);
+        buildExample2(dfa);
+    }
+    free(files);
+    dfaSetTrace(dfa, stdout);
+    dfaSetThreads(dfa, nThreads);
+    uint32_t initialDFAState = dfaInitialState(dfa);
+
+    char initialName[16];
+    printf("Original DFA defined. Initial state: %s. Number of states: %u\n",
+           stateLabel(dfa, initialDFAState, initialName), dfaStateCount(dfa));
+
+    if (compress) {
+        dfaCompressAlphabet(dfa);
+        printf("Alphabet compressed: %u symbols -> %u classes\n", dfaAlphabetSize(dfa), dfaClassCount(dfa));
+    }
 
     printf("\n--- Step 1: Removing Unreachable States ---\n");
-    removeUnreachable(initialDFAState);
-    printf("States after removing unreachable: %d\n", nStates);
+    dfaTrim(dfa, dropDead);
+    printf("States after removing unreachable%s: %u\n", dropDead ? " and dead" : "", dfaStateCount(dfa));
+    if (dfaIsAcyclic(dfa)) printf("DFA is acyclic: refined in one pass (Revuz)\n");
 
     printf("\n--- Step 2: Initial Partitioning ---\n");
-    initialPartition();
+    dfaInitialPartition(dfa);
 
     printf("\n--- Step 3: Refining Partitions ---\n");
-    refineAllPartitions();
+    dfaRefine(dfa, engine);
 
     printf("\n--- Step 4: Minimized DFA ---\n");
-    printMinimizedDFA();
+    printMinimizedDFA(dfa);
+
+    int result = EXIT_SUCCESS;
+    if (outputPath) {
+        if (saveMinimized(dfa, outputPath)) printf("\nMinimized DFA written to %s\n", outputPath);
+        else result = EXIT_FAILURE;
+    }
 
     // Clean up memory
     // Nettoyage de la mmoire
-    for (int i = 0; i < nStates; ++i) {
-        if(allStates[i] != NULL) free(allStates[i]);
-    }
-    return 0;
+    dfaDestroy(dfa);
+    return result;
 }
@@ -0,0 +1,1714 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void refinableFree(RefinablePartition *p) {
+    free(p->elems); free(p->loc); free(p->sidx);
+    free(p->first); free(p->end); free(p->mid); free(p->touched);
+    memset(p, 0, sizeof(*p));
+}
+
+// Regroups the elements of p by blockOf (ids below nBlocks, blockOf may be
+// p->sidx), keeping their current relative order within each block; blocks
+// keep the order of their ids and empty ids are dropped
+// Regroupe les lments de p selon blockOf (numros infrieurs  nBlocks,
+// blockOf peut tre p->sidx), en gardant leur ordre relatif dans chaque
+// bloc ; les blocs gardent l'ordre de leurs numros, les vides sont omis
+static void refinableRegroup(RefinablePartition *p, const uint32_t *blockOf, uint32_t nBlocks, ScratchArena *scratch) {
+    ArenaMark mark = arenaMark(scratch);
+    uint32_t *cursor = arenaAlloc(scratch, nBlocks, sizeof(uint32_t));
+    uint32_t *newId = arenaAlloc(scratch, nBlocks, sizeof(uint32_t));
+    uint32_t *order = arenaAlloc(scratch, p->nElems, sizeof(uint32_t));
+    for (uint32_t e = 0; e < p->nElems; ++e) cursor[blockOf[e]]++;
+    uint32_t pos = 0;
+    p->nBlocks = 0;
+    for (uint32_t b = 0; b < nBlocks; ++b) {
+        if (cursor[b] == 0) continue;
+        uint32_t z = p->nBlocks++;
+        newId[b] = z;
+        p->first[z] = p->mid[z] = pos;
+        pos += cursor[b];
+        p->end[z] = pos;
+        cursor[b] = p->first[z];
+    }
+    for (uint32_t i = 0; i < p->nElems; ++i) {
+        uint32_t e = p->elems[i];
+        order[cursor[blockOf[e]]++] = e;
+    }
+    for (uint32_t i = 0; i < p->nElems; ++i) {
+        uint32_t e = order[i];
+        p->elems[i] = e;
+        p->loc[e] = i;
+        p->sidx[e] = newId[blockOf[e]];
+    }
+    p->nTouched = 0;
+    arenaRelease(scratch, mark);
+}
+
+void refinableInit(RefinablePartition *p, uint32_t nElems, const uint32_t *blockOf, uint32_t nBlocks,
+                   ScratchArena *scratch) {
+    if (nElems > p->capacity || !p->elems) {
+        refinableFree(p);
+        p->capacity = nElems;
+        p->elems = xcalloc(nElems, sizeof(uint32_t));
+        p->loc = xcalloc(nElems, sizeof(uint32_t));
+        p->sidx = xcalloc(nElems, sizeof(uint32_t));
+        p->first = xcalloc(nElems, sizeof(uint32_t));
+        p->end = xcalloc(nElems, sizeof(uint32_t));
+        p->mid = xcalloc(nElems, sizeof(uint32_t));
+        p->touched = xcalloc(nElems, sizeof(uint32_t));
+    }
+    p->nElems = nElems;
+    for (uint32_t e = 0; e < nElems; ++e) p->elems[e] = e;
+    refinableRegroup(p, blockOf, nBlocks, scratch);
+}
+
+// Display name of a state: its own name, or "q<id>" for unnamed states
+// Nom affich d'un tat : son nom, ou "q<numro>" pour les tats anonymes
+static const char *stateLabel(const DfaMinimizer *d, uint32_t s, char buffer[16]) {
+    if (d->stateNames[s][0]) return d->stateNames[s];
+    snprintf(buffer, 16, "q%u", s);
+    return buffer;
+}
+
+// Builds the display label "{q1,q2,...}" of a partition (caller frees)
+// Construit le libell "{q1,q2,...}" d'une partition ( librer par l'appelant)
+static char *partitionLabel(const DfaMinimizer *d, uint32_t b) {
+    const RefinablePartition *p = &d->partition;
+    char buffer[16];
+    size_t len = 3;
+    for (uint32_t j = p->first[b]; j < p->end[b]; ++j) len += strlen(stateLabel(d, p->elems[j], buffer)) + 1;
+    char *label = xcalloc(len, 1);
+    char *out = label;
+    *out++ = '{';
+    for (uint32_t j = p->first[b]; j < p->end[b]; ++j) {
+        const char *name = stateLabel(d, p->elems[j], buffer);
+        size_t nameLen = strlen(name);
+        memcpy(out, name, nameLen);
+        out += nameLen;
+        if (j < p->end[b] - 1) *out++ = ',';
+    }
+    *out++ = '}';
+    *out = '\0';
+    return label;
+}
+
+// Prints every partition, one per line
+// Affiche chaque partition, une par ligne
+static void printPartitions(const DfaMinimizer *d, bool withNewStates) {
+    if (!d->trace) return;
+    for (uint32_t b = 0; b < d->partition.nBlocks; ++b) {
+        char *label = partitionLabel(d, b);
+        if (withNewStates) {
+            fprintf(d->trace, "  Partition %u (New State S%u) %s\n", b, b, label);
+        } else {
+            fprintf(d->trace, "  Partition %u %s\n", b, label);
+        }
+        free(label);
+    }
+}
+
+DfaMinimizer *dfaCreate(uint32_t alphabetSize) {
+    if (alphabetSize == 0) return NULL;
+    DfaMinimizer *d = xcalloc(1, sizeof(DfaMinimizer));
+    d->initialState = DFA_NO_STATE;
+    d->alphabetSize = alphabetSize;
+    d->nClasses = alphabetSize;
+    return d;
+}
+
+void dfaDestroy(DfaMinimizer *d) {
+    if (!d) return;
+    dfaReleaseMapping(d);
+    free(d->transitions);
+    free(d->intervalStart);
+    free(d->intervalClass);
+    free(d->classIntervals);
+    free(d->finalBits);
+    free(d->outputs);
+    free(d->stateNames);
+    free(d->reachable);
+    free(d->coReachable);
+    free(d->predStart);
+    free(d->preds);
+    stateSetFree(&d->edited);
+    stateSetFree(&d->changed);
+    refinableFree(&d->partition);
+    arenaFree(&d->scratch);
+    free(d);
+}
+
+void dfaSetTrace(DfaMinimizer *d, FILE *out) {
+    d->trace = out;
+}
+
+void dfaSetThreads(DfaMinimizer *d, int nThreads) {
+    d->nThreads = nThreads > 0 ? nThreads : 0;
+}
+
+// Drops the inverse transition index when the table is reshaped
+// Abandonne l'index des transitions inverses quand la table est remanie
+static void dropInverse(DfaMinimizer *d) {
+    free(d->predStart);
+    free(d->preds);
+    d->predStart = d->preds = NULL;
+    stateSetClear(&d->edited);
+    d->acyclic = false;
+}
+
+// Records that the row of s changed (or that s is new): the inverse index
+// keeps its other entries, and the partition knows what to re-examine
+// Note que la ligne de s a chang (ou que s est nouveau) : l'index inverse
+// garde ses autres entres, et la partition sait quoi rexaminer
+static void noteRowEdit(DfaMinimizer *d, uint32_t s) {
+    if (d->predStart) stateSetAdd(&d->edited, s);
+    if (d->partition.nBlocks > 0) stateSetAdd(&d->changed, s);
+    d->acyclic = false;
+}
+
+// Grows every per-state array to hold at least needed states (capacity doubles)
+// Agrandit chaque tableau par tat pour au moins needed tats (la capacit double)
+static bool reserveStates(DfaMinimizer *d, uint64_t needed) {
+    if (needed <= d->statesCapacity) return true;
+    dfaDetachMapping(d);
+    uint64_t capacity = d->statesCapacity ? d->statesCapacity : 64;
+    while (capacity < needed) capacity *= 2;
+    if (capacity > DFA_NO_STATE || capacity > SIZE_MAX / sizeof(uint32_t) / d->nClasses) return false;
+    uint32_t oldWords = (d->statesCapacity + 63) / 64;
+    d->statesCapacity = (uint32_t)capacity;
+    uint32_t words = (d->statesCapacity + 63) / 64;
+    d->transitions = xrealloc(d->transitions, (size_t)d->statesCapacity * d->nClasses, sizeof(uint32_t));
+    d->finalBits = xrealloc(d->finalBits, words, sizeof(uint64_t));
+    memset(d->finalBits + oldWords, 0, (words - oldWords) * sizeof(uint64_t));
+    if (d->outputs) d->outputs = xrealloc(d->outputs, d->statesCapacity, sizeof(int32_t));
+    d->stateNames = xrealloc(d->stateNames, d->statesCapacity, sizeof(*d->stateNames));
+    return true;
+}
+
+uint32_t dfaAddState(DfaMinimizer *d, const char *name, bool isFinal) {
+    if (!reserveStates(d, (uint64_t)d->nStates + 1)) return DFA_NO_STATE;
+    uint32_t s = d->nStates++;
+    memset(d->stateNames[s], 0, sizeof(d->stateNames[s]));
+    snprintf(d->stateNames[s], sizeof(d->stateNames[s]), "%s", name ? name : "");
+    setFinalState(d, s, isFinal);
+    if (d->outputs) d->outputs[s] = 0;
+    for (uint32_t sym = 0; sym < d->nClasses; ++sym) {
+        d->transitions[(size_t)s * d->nClasses + sym] = DFA_NO_STATE;
+    }
+    noteRowEdit(d, s);
+    if (d->initialState == DFA_NO_STATE) d->initialState = s;
+    return s;
+}
+
+uint32_t dfaAddStates(DfaMinimizer *d, uint32_t count) {
+    if (count == 0 || !reserveStates(d, (uint64_t)d->nStates + count)) return DFA_NO_STATE;
+    uint32_t firstId = d->nStates;
+    size_t cells = (size_t)count * d->nClasses;
+    uint32_t *row = &d->transitions[(size_t)firstId * d->nClasses];
+    for (size_t i = 0; i < cells; ++i) row[i] = DFA_NO_STATE;
+    memset(d->stateNames + firstId, 0, (size_t)count * sizeof(*d->stateNames));
+    for (uint32_t s = firstId; s < firstId + count; ++s) setFinalState(d, s, false);
+    if (d->outputs) memset(d->outputs + firstId, 0, (size_t)count * sizeof(int32_t));
+    d->nStates += count;
+    for (uint32_t s = firstId; s < d->nStates; ++s) noteRowEdit(d, s);
+    if (d->initialState == DFA_NO_STATE) d->initialState = firstId;
+    return firstId;
+}
+
+DfaStatus dfaSetFinal(DfaMinimizer *d, uint32_t state, bool isFinal) {
+    if (state >= d->nStates) return DFA_ERR_INVALID;
+    if (isFinalState(d, state) != isFinal && d->partition.nBlocks > 0) stateSetAdd(&d->changed, state);
+    setFinalState(d, state, isFinal);
+    return DFA_OK;
+}
+
+DfaStatus dfaSetOutput(DfaMinimizer *d, uint32_t state, int32_t output) {
+    if (state >= d->nStates) return DFA_ERR_INVALID;
+    if (stateOutput(d, state) == output) return DFA_OK;
+    if (d->partition.nBlocks > 0) stateSetAdd(&d->changed, state);
+
+    // The array appears with the first non-zero class
+    // Le tableau apparat avec la premire classe non nulle
+    if (!d->outputs) d->outputs = xcalloc(d->statesCapacity, sizeof(int32_t));
+    d->outputs[state] = output;
+    return DFA_OK;
+}
+
+// Clears every transition of p into state
+// Efface chaque transition de p vers state
+static void dropTransitionsTo(DfaMinimizer *d, uint32_t p, uint32_t state) {
+    uint32_t *row = &d->transitions[(size_t)p * d->nClasses];
+    bool any = false;
+    for (uint32_t c = 0; c < d->nClasses; ++c) {
+        if (row[c] != state) continue;
+        row[c] = DFA_NO_STATE;
+        any = true;
+    }
+    if (any) noteRowEdit(d, p);
+}
+
+DfaStatus dfaRemoveState(DfaMinimizer *d, uint32_t state) {
+    if (state >= d->nStates || state == d->initialState) return DFA_ERR_INVALID;
+    if (!d->predStart) dfaEnsureInverse(d);
+
+    // Incoming transitions: the index lists those of unedited states, and
+    // edited states (the list grows while scanned) are checked row by row
+    // Transitions entrantes : l'index donne celles des tats non modifis,
+    // les tats modifis (la liste grandit pendant le parcours) sont
+    // vrifis ligne par ligne
+    if (state < d->inverseStates) {
+        size_t slot = (size_t)state * d->nClasses;
+        for (uint32_t e = d->predStart[slot]; e < d->predStart[slot + d->nClasses]; ++e) {
+            if (!stateSetHas(&d->edited, d->preds[e])) dropTransitionsTo(d, d->preds[e], state);
+        }
+    }
+    for (uint32_t i = 0; i < d->edited.count; ++i) dropTransitionsTo(d, d->edited.states[i], state);
+
+    // Its own row: a state without transitions is never reached again
+    // Sa propre ligne : un tat sans transition n'est plus jamais atteint
+    uint32_t *row = &d->transitions[(size_t)state * d->nClasses];
+    for (uint32_t c = 0; c < d->nClasses; ++c) row[c] = DFA_NO_STATE;
+    noteRowEdit(d, state);
+    dfaSetFinal(d, state, false);
+    dfaSetOutput(d, state, 0);
+    return DFA_OK;
+}
+
+static int compareSymbols(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Counts the intervals of each column, on the first edit that needs it
+// Compte les intervalles de chaque colonne,  la premire modification qui en a besoin
+static void countClassIntervals(DfaMinimizer *d) {
+    if (d->classIntervals) return;
+    d->classIntervals = xcalloc(d->nClasses, sizeof(uint32_t));
+    for (uint32_t i = 0; i < d->nIntervals; ++i) d->classIntervals[d->intervalClass[i]]++;
+}
+
+// Cuts the interval holding sym so that one starts at sym; the arrays
+// double when full
+// Coupe l'intervalle contenant sym pour qu'un intervalle commence en sym ;
+// les tableaux doublent quand ils sont pleins
+static void cutInterval(DfaMinimizer *d, uint32_t sym) {
+    uint32_t i = symbolInterval(d, sym);
+    if (d->intervalStart[i] == sym) return;
+    if (d->nIntervals >= d->intervalsCapacity) {
+        // A new cut implies nIntervals < alphabetSize
+        // Une nouvelle coupure implique nIntervals < alphabetSize
+        d->intervalsCapacity = d->nIntervals < d->alphabetSize / 2 ? 2 * d->nIntervals : d->alphabetSize;
+        d->intervalStart = xrealloc(d->intervalStart, d->intervalsCapacity, sizeof(uint32_t));
+        d->intervalClass = xrealloc(d->intervalClass, d->intervalsCapacity, sizeof(uint32_t));
+    }
+    memmove(&d->intervalStart[i + 2], &d->intervalStart[i + 1], (d->nIntervals - i - 1) * sizeof(uint32_t));
+    memmove(&d->intervalClass[i + 2], &d->intervalClass[i + 1], (d->nIntervals - i - 1) * sizeof(uint32_t));
+    d->intervalStart[i + 1] = sym;
+    d->intervalClass[i + 1] = d->intervalClass[i];
+    d->classIntervals[d->intervalClass[i]]++;
+    d->nIntervals++;
+}
+
+// Restrides the table to hold at least needed spare columns, doubling the
+// column count (never beyond one column per symbol)
+// largit la table pour au moins needed colonnes de rserve, en doublant le
+// nombre de colonnes (jamais plus d'une colonne par symbole)
+static bool reserveClasses(DfaMinimizer *d, uint32_t needed) {
+    uint32_t k = d->nClasses;
+    uint64_t wide = (uint64_t)k - d->spareClasses + needed;
+    if (wide < 2 * (uint64_t)k) wide = 2 * (uint64_t)k;
+    if (wide > d->alphabetSize) wide = d->alphabetSize;
+    if (d->statesCapacity > SIZE_MAX / sizeof(uint32_t) / wide) return false;
+    uint32_t *widened = xcalloc((size_t)d->statesCapacity * wide, sizeof(uint32_t));
+    for (uint32_t s = 0; s < d->nStates; ++s) {
+        uint32_t *dst = &widened[(size_t)s * wide];
+        memcpy(dst, &d->transitions[(size_t)s * k], k * sizeof(uint32_t));
+        for (uint32_t c = k; c < wide; ++c) dst[c] = DFA_NO_STATE;
+    }
+    free(d->transitions);
+    d->transitions = widened;
+    d->classIntervals = xrealloc(d->classIntervals, wide, sizeof(uint32_t));
+    memset(d->classIntervals + k, 0, (wide - k) * sizeof(uint32_t));
+    d->spareClasses += (uint32_t)wide - k;
+    d->nClasses = (uint32_t)wide;
+    return true;
+}
+
+// Packs the spare columns away (the table keeps its column count otherwise)
+// Retire les colonnes de rserve (la table garde sinon son nombre de colonnes)
+static void dropSpareClasses(DfaMinimizer *d) {
+    if (d->spareClasses == 0) return;
+    dropInverse(d);
+    uint32_t k = d->nClasses, used = k - d->spareClasses;
+    for (uint32_t s = 0; s < d->nStates; ++s) {
+        memmove(&d->transitions[(size_t)s * used], &d->transitions[(size_t)s * k], used * sizeof(uint32_t));
+    }
+    if (d->statesCapacity) {
+        d->transitions = xrealloc(d->transitions, (size_t)d->statesCapacity * used, sizeof(uint32_t));
+    }
+    free(d->classIntervals);
+    d->classIntervals = NULL;
+    d->nClasses = used;
+    d->spareClasses = 0;
+}
+
+// Makes the symbols lo..hi a union of whole classes on a compressed
+// alphabet: the intervals are cut at lo and hi + 1, and every class lying
+// partly outside the range copies its column into a spare one for its
+// inside intervals, O(n) per split class. Returns the intervals first..last
+// that cover the range, or false if the wider table would not fit.
+// Fait des symboles lo..hi une union de classes entires d'un alphabet
+// compress : les intervalles sont coups en lo et hi + 1, et chaque classe
+// en partie hors de la plage copie sa colonne dans une colonne de rserve
+// pour ses intervalles intrieurs, O(n) par classe spare. Renvoie les
+// intervalles first..last qui couvrent la plage, ou false si la table
+// largie ne tient pas.
+static bool isolateRange(DfaMinimizer *d, uint32_t lo, uint32_t hi, uint32_t *first, uint32_t *last) {
+    dfaDetachMapping(d);
+    countClassIntervals(d);
+    cutInterval(d, lo);
+    if (hi + 1 < d->alphabetSize) cutInterval(d, hi + 1);
+    *first = symbolInterval(d, lo);
+    *last = symbolInterval(d, hi);
+
+    // The classes of the range, sorted: a run of one class shorter than its
+    // interval count marks a class to split
+    // Les classes de la plage, tries : une suite d'une mme classe plus
+    // courte que son nombre d'intervalles marque une classe  sparer
+    uint32_t r = *last - *first + 1;
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *inside = arenaAlloc(&d->scratch, r, sizeof(uint32_t));
+    uint32_t *column = arenaAlloc(&d->scratch, r, sizeof(uint32_t));
+    memcpy(inside, &d->intervalClass[*first], r * sizeof(uint32_t));
+    qsort(inside, r, sizeof(uint32_t), compareSymbols);
+    uint32_t nSplit = 0;
+    for (uint32_t j = 0, end = 0; j < r; j = end) {
+        while (end < r && inside[end] == inside[j]) ++end;
+        nSplit += end - j < d->classIntervals[inside[j]];
+    }
+    if (nSplit > d->spareClasses && !reserveClasses(d, nSplit)) {
+        arenaRelease(&d->scratch, mark);
+        return false;
+    }
+    if (nSplit > 0) dropInverse(d);
+
+    // column[j] at the start of each run: the column of its inside intervals
+    // column[j] au dbut de chaque suite : la colonne de ses intervalles intrieurs
+    uint32_t k = d->nClasses;
+    for (uint32_t j = 0, end = 0; j < r; j = end) {
+        uint32_t c = inside[j];
+        while (end < r && inside[end] == c) ++end;
+        column[j] = c;
+        if (end - j == d->classIntervals[c]) continue;
+        uint32_t spare = k - d->spareClasses--;
+        for (uint32_t s = 0; s < d->nStates; ++s) {
+            d->transitions[(size_t)s * k + spare] = d->transitions[(size_t)s * k + c];
+        }
+        d->classIntervals[c] -= end - j;
+        d->classIntervals[spare] = end - j;
+        column[j] = spare;
+    }
+    for (uint32_t i = *first; i <= *last && nSplit > 0; ++i) {
+        uint32_t lower = 0, upper = r;
+        while (lower < upper) {
+            uint32_t mid = lower + (upper - lower) / 2;
+            if (inside[mid] < d->intervalClass[i]) lower = mid + 1; else upper = mid;
+        }
+        d->intervalClass[i] = column[lower];
+    }
+    arenaRelease(&d->scratch, mark);
+    return true;
+}
+
+DfaStatus dfaSetTransitionRange(DfaMinimizer *d, uint32_t from, int lo, int hi, uint32_t to) {
+    if (from >= d->nStates || lo < 0 || lo > hi || (uint32_t)hi >= d->alphabetSize) return DFA_ERR_INVALID;
+    if (to != DFA_NO_STATE && to >= d->nStates) return DFA_ERR_INVALID;
+    uint32_t *row = &d->transitions[(size_t)from * d->nClasses];
+    bool changed = false;
+    if (!d->intervalClass) {
+        for (uint32_t sym = (uint32_t)lo; sym <= (uint32_t)hi; ++sym) {
+            changed |= row[sym] != to;
+            row[sym] = to;
+        }
+    } else {
+        // Nothing to split if the range already leads to the target
+        // Rien  sparer si la plage mne dj  la cible
+        uint32_t i = symbolInterval(d, (uint32_t)lo);
+        while (i < d->nIntervals && d->intervalStart[i] <= (uint32_t)hi && row[d->intervalClass[i]] == to) ++i;
+        if (i == d->nIntervals || d->intervalStart[i] > (uint32_t)hi) return DFA_OK;
+
+        uint32_t first, last;
+        if (!isolateRange(d, (uint32_t)lo, (uint32_t)hi, &first, &last)) return DFA_ERR_INVALID;
+        row = &d->transitions[(size_t)from * d->nClasses];
+        for (uint32_t j = first; j <= last; ++j) {
+            changed |= row[d->intervalClass[j]] != to;
+            row[d->intervalClass[j]] = to;
+        }
+    }
+    if (changed) noteRowEdit(d, from);
+    return DFA_OK;
+}
+
+DfaStatus dfaSetTransition(DfaMinimizer *d, uint32_t from, int sym, uint32_t to) {
+    return dfaSetTransitionRange(d, from, sym, sym, to);
+}
+
+// A segment whose class is split by the final target of one source
+// Un segment dont la classe est spare par la cible finale d'une source
+typedef struct {
+    uint32_t cls;
+    uint32_t target;
+    uint32_t segment;
+} SegmentSplit;
+
+static int compareSplits(const void *x, const void *y) {
+    const SegmentSplit *a = x, *b = y;
+    if (a->cls != b->cls) return a->cls < b->cls ? -1 : 1;
+    if (a->target != b->target) return a->target < b->target ? -1 : 1;
+    return a->segment < b->segment ? -1 : a->segment > b->segment;
+}
+
+// Applies the edits to a compressed alphabet in one pass. Every boundary
+// is cut at once into segments (the old intervals split at each lo and
+// hi + 1), and a segment's class starts as its old column; the sources are
+// then taken in turn, and each class is split by the final target of the
+// source on its segments wherever that target differs from the old one.
+// The table is rebuilt once, one column per class. Nothing is changed if
+// conflict is set and an edit conflicts, or if the table would not fit.
+// Applique les modifications  un alphabet compress en une passe. Toutes
+// les bornes sont coupes d'un coup en segments (les anciens intervalles
+// coups  chaque lo et hi + 1), et la classe d'un segment est d'abord son
+// ancienne colonne ; les sources sont ensuite prises tour  tour, et chaque
+// classe est spare selon la cible finale de la source sur ses segments l
+// o elle diffre de l'ancienne. La table est reconstruite une fois, une
+// colonne par classe. Rien ne change si conflict est donn et qu'une
+// modification est en conflit, ou si la table ne tient pas.
+static DfaStatus setRangesCompressed(DfaMinimizer *d, const DfaRangeEdit *edits, size_t count, size_t *conflict) {
+    ScratchArena *a = &d->scratch;
+    ArenaMark mark = arenaMark(a);
+    uint32_t k = d->nClasses;
+
+    // Segments: sorted, unique cuts, each with its old column
+    // Segments : coupures tries et uniques, chacune avec son ancienne colonne
+    size_t nCuts = d->nIntervals;
+    uint32_t *segStart = arenaAlloc(a, d->nIntervals + 2 * count, sizeof(uint32_t));
+    memcpy(segStart, d->intervalStart, d->nIntervals * sizeof(uint32_t));
+    for (size_t e = 0; e < count; ++e) {
+        segStart[nCuts++] = (uint32_t)edits[e].lo;
+        if ((uint32_t)edits[e].hi + 1 < d->alphabetSize) segStart[nCuts++] = (uint32_t)edits[e].hi + 1;
+    }
+    qsort(segStart, nCuts, sizeof(uint32_t), compareSymbols);
+    uint32_t nSeg = 0;
+    for (size_t i = 0; i < nCuts; ++i) {
+        if (nSeg == 0 || segStart[nSeg - 1] != segStart[i]) segStart[nSeg++] = segStart[i];
+    }
+    uint32_t *oldCol = arenaAlloc(a, nSeg, sizeof(uint32_t));
+    for (uint32_t s = 0, i = 0; s < nSeg; ++s) {
+        while (i + 1 < d->nIntervals && d->intervalStart[i + 1] <= segStart[s]) ++i;
+        oldCol[s] = d->intervalClass[i];
+    }
+
+    // First and last segment of each edit, and the edits grouped by source
+    // in index order (counting sort)
+    // Premier et dernier segment de chaque modification, et les
+    // modifications groupes par source dans l'ordre des indices (tri par
+    // dnombrement)
+    uint32_t *segFirst = arenaAlloc(a, count, sizeof(uint32_t));
+    uint32_t *segLast = arenaAlloc(a, count, sizeof(uint32_t));
+    for (size_t e = 0; e < count; ++e) {
+        for (int side = 0; side < 2; ++side) {
+            uint32_t sym = (uint32_t)(side ? edits[e].hi : edits[e].lo);
+            uint32_t lower = 0, upper = nSeg;
+            while (upper - lower > 1) {
+                uint32_t mid = lower + (upper - lower) / 2;
+                if (segStart[mid] <= sym) lower = mid; else upper = mid;
+            }
+            (side ? segLast : segFirst)[e] = lower;
+        }
+    }
+    uint32_t n = d->nStates;
+    size_t *groupStart = arenaAlloc(a, (size_t)n + 1, sizeof(size_t));
+    size_t *grouped = arenaAlloc(a, count, sizeof(size_t));
+    for (size_t e = 0; e < count; ++e) groupStart[edits[e].from + 1]++;
+    for (uint32_t s = 0; s < n; ++s) groupStart[s + 1] += groupStart[s];
+    for (size_t e = 0; e < count; ++e) grouped[groupStart[edits[e].from]++] = e;
+    memmove(groupStart + 1, groupStart, (size_t)n * sizeof(size_t));
+    groupStart[0] = 0;
+
+    // Per source: the final target of each touched segment, then the split
+    // of each class by that target where it changed
+    // Par source : la cible finale de chaque segment touch, puis la
+    // sparation de chaque classe selon cette cible l o elle a chang
+    uint32_t *cls = arenaAlloc(a, nSeg, sizeof(uint32_t));
+    uint32_t *label = arenaAlloc(a, nSeg, sizeof(uint32_t));
+    uint32_t *stamp = arenaAlloc(a, nSeg, sizeof(uint32_t));   // Source + 1 that set label
+    uint32_t *touched = arenaAlloc(a, nSeg, sizeof(uint32_t));
+    SegmentSplit *splits = arenaAlloc(a, nSeg, sizeof(SegmentSplit));
+    memcpy(cls, oldCol, nSeg * sizeof(uint32_t));
+    uint32_t nClasses = k;
+    size_t firstConflict = count;
+    bool any = false;
+    for (uint32_t f = 0; f < n; ++f) {
+        const uint32_t *row = &d->transitions[(size_t)f * k];
+        uint32_t nTouched = 0, nSplits = 0;
+        for (size_t g = groupStart[f]; g < groupStart[f + 1]; ++g) {
+            size_t e = grouped[g];
+            for (uint32_t s = segFirst[e]; s <= segLast[e]; ++s) {
+                uint32_t previous = stamp[s] == f + 1 ? label[s] : row[oldCol[s]];
+                if (conflict && previous != DFA_NO_STATE && previous != edits[e].to) {
+                    if (e < firstConflict) firstConflict = e;
+                    break;
+                }
+                if (stamp[s] != f + 1) touched[nTouched++] = s;
+                stamp[s] = f + 1;
+                label[s] = edits[e].to;
+            }
+        }
+        for (uint32_t t = 0; t < nTouched; ++t) {
+            uint32_t s = touched[t];
+            if (label[s] == row[oldCol[s]]) continue;
+            splits[nSplits++] = (SegmentSplit){ cls[s], label[s], s };
+        }
+        if (nSplits == 0) continue;
+        any = true;
+        qsort(splits, nSplits, sizeof(SegmentSplit), compareSplits);
+        for (uint32_t t = 0; t < nSplits; ++t) {
+            if (t > 0 && splits[t].cls == splits[t - 1].cls && splits[t].target == splits[t - 1].target) {
+                cls[splits[t].segment] = cls[splits[t - 1].segment];
+            } else {
+                cls[splits[t].segment] = nClasses++;
+            }
+        }
+    }
+    if (firstConflict < count) {
+        *conflict = firstConflict;
+        arenaRelease(a, mark);
+        return DFA_ERR_INVALID;
+    }
+    if (!any) {
+        arenaRelease(a, mark);
+        return DFA_OK;
+    }
+
+    // Classes numbered by first segment, neighbouring segments of one class
+    // merged; the old column of a class is that of its first segment
+    // Classes numrotes par premier segment, segments voisins d'une mme
+    // classe fusionns ; l'ancienne colonne d'une classe est celle de son
+    // premier segment
+    uint32_t *renumber = arenaAlloc(a, nClasses, sizeof(uint32_t));
+    uint32_t *source = arenaAlloc(a, nSeg, sizeof(uint32_t));
+    memset(renumber, 0xff, nClasses * sizeof(uint32_t));
+    uint32_t nNumbered = 0, nIntervals = 0;
+    for (uint32_t s = 0; s < nSeg; ++s) {
+        if (renumber[cls[s]] == DFA_NO_STATE) {
+            source[nNumbered] = oldCol[s];
+            renumber[cls[s]] = nNumbered++;
+        }
+        cls[s] = renumber[cls[s]];
+        if (s > 0 && cls[s] == cls[s - 1]) continue;
+        nIntervals++;
+    }
+    if (d->statesCapacity > SIZE_MAX / sizeof(uint32_t) / nNumbered) {
+        if (conflict) *conflict = count;
+        arenaRelease(a, mark);
+        return DFA_ERR_INVALID;
+    }
+
+    dropInverse(d);
+    uint32_t *table = xcalloc((size_t)d->statesCapacity * nNumbered, sizeof(uint32_t));
+    for (uint32_t s = 0; s < n; ++s) {
+        const uint32_t *src = &d->transitions[(size_t)s * k];
+        uint32_t *dst = &table[(size_t)s * nNumbered];
+        for (uint32_t c = 0; c < nNumbered; ++c) dst[c] = src[source[c]];
+    }
+    for (size_t e = 0; e < count; ++e) {
+        uint32_t *dst = &table[(size_t)edits[e].from * nNumbered];
+        for (uint32_t s = segFirst[e]; s <= segLast[e]; ++s) dst[cls[s]] = edits[e].to;
+    }
+    free(d->transitions);
+    free(d->intervalStart);
+    free(d->intervalClass);
+    free(d->classIntervals);
+    d->transitions = table;
+    d->nClasses = nNumbered;
+    d->spareClasses = 0;
+    d->classIntervals = NULL;
+    d->nIntervals = d->intervalsCapacity = nIntervals;
+    d->intervalStart = xcalloc(nIntervals, sizeof(uint32_t));
+    d->intervalClass = xcalloc(nIntervals, sizeof(uint32_t));
+    for (uint32_t s = 0, i = 0; s < nSeg; ++s) {
+        if (s > 0 && cls[s] == cls[s - 1]) continue;
+        d->intervalStart[i] = segStart[s];
+        d->intervalClass[i++] = cls[s];
+    }
+    for (uint32_t f = 0; f < n; ++f) {
+        if (groupStart[f + 1] > groupStart[f]) noteRowEdit(d, f);
+    }
+    arenaRelease(a, mark);
+    return DFA_OK;
+}
+
+DfaStatus dfaSetTransitionRanges(DfaMinimizer *d, const DfaRangeEdit *edits, size_t count, size_t *conflict) {
+    for (size_t e = 0; e < count; ++e) {
+        const DfaRangeEdit *x = &edits[e];
+        if (x->from >= d->nStates || x->lo < 0 || x->lo > x->hi || (uint32_t)x->hi >= d->alphabetSize ||
+            (x->to != DFA_NO_STATE && x->to >= d->nStates)) {
+            if (conflict) *conflict = e;
+            return DFA_ERR_INVALID;
+        }
+    }
+    if (count == 0) return DFA_OK;
+    if (d->intervalClass) {
+        dfaDetachMapping(d);
+        return setRangesCompressed(d, edits, count, conflict);
+    }
+
+    // One column per symbol: conflicts are checked against a copy of the
+    // edited part of each row, then the edits go straight into the table
+    // Une colonne par symbole : les conflits sont vrifis sur une copie de
+    // la partie modifie de chaque ligne, puis les modifications vont
+    // directement dans la table
+    if (conflict) {
+        ArenaMark mark = arenaMark(&d->scratch);
+        uint32_t *label = arenaAlloc(&d->scratch, d->alphabetSize, sizeof(uint32_t));
+        uint64_t *stamp = arenaAlloc(&d->scratch, d->alphabetSize, sizeof(uint64_t));   // Edit + 1 of the row's first pass
+        size_t *groupStart = arenaAlloc(&d->scratch, (size_t)d->nStates + 1, sizeof(size_t));
+        size_t *grouped = arenaAlloc(&d->scratch, count, sizeof(size_t));
+        for (size_t e = 0; e < count; ++e) groupStart[edits[e].from + 1]++;
+        for (uint32_t s = 0; s < d->nStates; ++s) groupStart[s + 1] += groupStart[s];
+        for (size_t e = 0; e < count; ++e) grouped[groupStart[edits[e].from]++] = e;
+        memmove(groupStart + 1, groupStart, (size_t)d->nStates * sizeof(size_t));
+        groupStart[0] = 0;
+        size_t firstConflict = count;
+        for (uint32_t f = 0; f < d->nStates; ++f) {
+            if (groupStart[f] == groupStart[f + 1]) continue;
+            const uint32_t *row = &d->transitions[(size_t)f * d->nClasses];
+            uint64_t id = grouped[groupStart[f]] + 1;
+            for (size_t g = groupStart[f]; g < groupStart[f + 1]; ++g) {
+                const DfaRangeEdit *x = &edits[grouped[g]];
+                for (uint32_t sym = (uint32_t)x->lo; sym <= (uint32_t)x->hi; ++sym) {
+                    uint32_t previous = stamp[sym] == id ? label[sym] : row[sym];
+                    if (previous != DFA_NO_STATE && previous != x->to) {
+                        if (grouped[g] < firstConflict) firstConflict = grouped[g];
+                        break;
+                    }
+                    stamp[sym] = id;
+                    label[sym] = x->to;
+                }
+            }
+        }
+        arenaRelease(&d->scratch, mark);
+        if (firstConflict < count) {
+            *conflict = firstConflict;
+            return DFA_ERR_INVALID;
+        }
+    }
+    for (size_t e = 0; e < count; ++e) {
+        dfaSetTransitionRange(d, edits[e].from, edits[e].lo, edits[e].hi, edits[e].to);
+    }
+    return DFA_OK;
+}
+
+// Hashes every column of the table in one row-major pass and merges the
+// columns that are equal, then rebuilds the intervals as maximal runs of
+// symbols of one class; classes are numbered by first symbol.
+// Hache chaque colonne de la table en un seul parcours par lignes et
+// fusionne les colonnes gales, puis reconstruit les intervalles comme plus
+// longues suites de symboles d'une mme classe ; les classes sont numrotes
+// par premier symbole.
+DfaStatus dfaCompressAlphabet(DfaMinimizer *d) {
+    dfaDetachMapping(d);
+    dropInverse(d);
+    uint32_t k = d->nClasses;
+    uint64_t *hash = xcalloc(k, sizeof(uint64_t));
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        const uint32_t *row = &d->transitions[(size_t)i * k];
+        for (uint32_t c = 0; c < k; ++c) {
+            hash[c] = (hash[c] ^ row[c]) * UINT64_C(0x100000001b3);
+        }
+    }
+
+    // Open-addressing table from column hash to class representative;
+    // equal hashes are confirmed by comparing the columns
+    // Table  adressage ouvert du hachage de colonne vers le reprsentant de
+    // classe ; les hachages gaux sont confirms en comparant les colonnes
+    uint32_t tableSize = 1;
+    while (tableSize < 2 * k) tableSize *= 2;
+    uint32_t *table = xcalloc(tableSize, sizeof(uint32_t));
+    for (uint32_t i = 0; i < tableSize; ++i) table[i] = DFA_NO_STATE;
+    uint32_t *columnClass = xcalloc(k, sizeof(uint32_t));
+    uint32_t *representative = xcalloc(k, sizeof(uint32_t));
+    uint32_t nClasses = 0;
+    for (uint32_t col = 0; col < k; ++col) {
+        uint32_t slot = (uint32_t)(hash[col] ^ (hash[col] >> 32)) & (tableSize - 1);
+        for (;; slot = (slot + 1) & (tableSize - 1)) {
+            uint32_t c = table[slot];
+            if (c == DFA_NO_STATE) {
+                table[slot] = columnClass[col] = nClasses;
+                representative[nClasses++] = col;
+                break;
+            }
+            uint32_t rep = representative[c];
+            if (hash[rep] != hash[col]) continue;
+            uint32_t i = 0;
+            while (i < d->nStates && d->transitions[(size_t)i * k + rep] == d->transitions[(size_t)i * k + col]) ++i;
+            if (i == d->nStates) {
+                columnClass[col] = c;
+                break;
+            }
+        }
+    }
+    free(table);
+    free(hash);
+
+    // Runs of symbols: one per symbol while uncompressed, else the intervals
+    // Suites de symboles : une par symbole sans compression, sinon les intervalles
+    uint32_t nRuns = d->intervalClass ? d->nIntervals : k;
+    uint32_t *runStart = xcalloc(nRuns, sizeof(uint32_t));
+    uint32_t *runClass = xcalloc(nRuns, sizeof(uint32_t));
+    uint32_t *order = xcalloc(nClasses, sizeof(uint32_t));   // Representative column per number
+    uint32_t nIntervals = 0;
+
+    // Number the classes by first symbol, merging neighbouring runs; a
+    // class no interval uses (a spare column) gets no number
+    // Numrote les classes par premier symbole, en fusionnant les suites
+    // voisines ; une classe sans intervalle (colonne de rserve) n'a pas de
+    // numro
+    uint32_t *renumber = xcalloc(nClasses, sizeof(uint32_t));
+    for (uint32_t c = 0; c < nClasses; ++c) renumber[c] = DFA_NO_STATE;
+    uint32_t nNumbered = 0;
+    for (uint32_t r = 0; r < nRuns; ++r) {
+        uint32_t c = columnClass[d->intervalClass ? d->intervalClass[r] : r];
+        if (renumber[c] == DFA_NO_STATE) {
+            order[nNumbered] = representative[c];
+            renumber[c] = nNumbered++;
+        }
+        if (nIntervals > 0 && runClass[nIntervals - 1] == renumber[c]) continue;
+        runStart[nIntervals] = d->intervalClass ? d->intervalStart[r] : r;
+        runClass[nIntervals++] = renumber[c];
+    }
+
+    // Keep one column per numbered class, compacting rows in place through
+    // a copy of the row: row i is read whole before being written at
+    // i * nNumbered <= i * k
+    // Garde une colonne par classe numrote en compactant les lignes sur
+    // place via une copie de la ligne : la ligne i est lue en entier avant
+    // d'tre crite en i * nNumbered <= i * k
+    uint32_t *scratch = xcalloc(nNumbered, sizeof(uint32_t));
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        const uint32_t *row = &d->transitions[(size_t)i * k];
+        for (uint32_t c = 0; c < nNumbered; ++c) scratch[c] = row[order[c]];
+        memcpy(&d->transitions[(size_t)i * nNumbered], scratch, nNumbered * sizeof(uint32_t));
+    }
+    free(scratch);
+    if (d->statesCapacity) {
+        d->transitions = xrealloc(d->transitions, (size_t)d->statesCapacity * nNumbered, sizeof(uint32_t));
+    }
+    free(d->intervalStart);
+    free(d->intervalClass);
+    free(d->classIntervals);
+    d->classIntervals = NULL;
+    d->nClasses = nNumbered;
+    d->spareClasses = 0;
+    d->nIntervals = d->intervalsCapacity = nIntervals;
+    d->intervalStart = xrealloc(runStart, nIntervals, sizeof(uint32_t));
+    d->intervalClass = xrealloc(runClass, nIntervals, sizeof(uint32_t));
+    free(renumber);
+
+    free(order);
+    free(representative);
+    free(columnClass);
+    return DFA_OK;
+}
+
+// Rebuilds the full table from the intervals
+// Reconstruit la table complte  partir des intervalles
+DfaStatus dfaExpandAlphabet(DfaMinimizer *d) {
+    if (!d->intervalClass) return DFA_OK;
+    dfaDetachMapping(d);
+    dropInverse(d);
+    uint32_t k = d->alphabetSize;
+    uint32_t *expanded = xcalloc((size_t)d->statesCapacity * k, sizeof(uint32_t));
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        for (uint32_t j = 0; j < d->nIntervals; ++j) {
+            uint32_t target = d->transitions[(size_t)i * d->nClasses + d->intervalClass[j]];
+            for (uint32_t sym = d->intervalStart[j]; sym < intervalEnd(d, j); ++sym) {
+                expanded[(size_t)i * k + sym] = target;
+            }
+        }
+    }
+    free(d->transitions);
+    free(d->intervalStart);
+    free(d->intervalClass);
+    free(d->classIntervals);
+    d->transitions = expanded;
+    d->intervalStart = d->intervalClass = d->classIntervals = NULL;
+    d->nIntervals = d->intervalsCapacity = 0;
+    d->nClasses = k;
+    d->spareClasses = 0;
+    return DFA_OK;
+}
+
+uint32_t dfaClassCount(const DfaMinimizer *d) {
+    return d->nClasses - d->spareClasses;
+}
+
+uint32_t dfaSymbolClass(const DfaMinimizer *d, int sym) {
+    if (sym < 0 || (uint32_t)sym >= d->alphabetSize) return DFA_NO_STATE;
+    return symbolColumn(d, (uint32_t)sym);
+}
+
+int dfaIntervalEnd(const DfaMinimizer *d, int sym) {
+    if (sym < 0 || (uint32_t)sym >= d->alphabetSize) return -1;
+    if (!d->intervalClass) return sym;
+    return (int)(intervalEnd(d, symbolInterval(d, (uint32_t)sym)) - 1);
+}
+
+DfaStatus dfaSetInitial(DfaMinimizer *d, uint32_t state) {
+    if (state >= d->nStates) return DFA_ERR_INVALID;
+    d->initialState = state;
+    return DFA_OK;
+}
+
+// Marks all states reachable from startNode with an iterative depth-first
+// walk, O(n + m). An edge back to a state still on the current path closes
+// a cycle, so the walk also tells whether the reachable part is acyclic.
+// Marque tous les tats accessibles depuis startNode par un parcours en
+// profondeur itratif, O(n + m). Un arc vers un tat encore sur le chemin
+// courant ferme un cycle : le parcours indique aussi si la partie
+// accessible est acyclique.
+DFA_ALWAYS_INLINE void markReachableKernel(DfaMinimizer *d, uint32_t startNode, bool *acyclic, const uint32_t k) {
+    // Initialize all states as unreachable
+    // Initialise tous les tats comme inaccessibles
+    d->reachable = xrealloc(d->reachable, d->nStates, sizeof(bool));
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        d->reachable[i] = false;
+    }
+
+    *acyclic = true;
+    if (startNode >= d->nStates) return;
+
+    // The path holds each state with the next symbol to follow from it;
+    // every state is pushed at most once, when first reached
+    // Le chemin garde chaque tat avec le prochain symbole  suivre ;
+    // chaque tat est empil au plus une fois,  sa dcouverte
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *pathState = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    uint32_t *pathSym = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    bool *onPath = arenaAlloc(&d->scratch, d->nStates, sizeof(bool));
+    uint32_t depth = 0;
+    d->reachable[startNode] = onPath[startNode] = true;
+    pathState[depth] = startNode;
+    pathSym[depth++] = 0;
+
+    while (depth > 0) {
+        uint32_t s = pathState[depth - 1];
+        uint32_t sym = pathSym[depth - 1]++;
+        if (sym == k) {
+            onPath[s] = false;
+            depth--;
+            continue;
+        }
+        uint32_t targetIndex = d->transitions[(size_t)s * k + sym];
+        if (targetIndex == DFA_NO_STATE) continue;
+        if (!d->reachable[targetIndex]) {
+            d->reachable[targetIndex] = onPath[targetIndex] = true;
+            pathState[depth] = targetIndex;
+            pathSym[depth++] = 0;
+        } else if (onPath[targetIndex]) {
+            *acyclic = false;
+        }
+    }
+    arenaRelease(&d->scratch, mark);
+}
+
+static void markReachable(DfaMinimizer *d, uint32_t startNode, bool *acyclic) {
+    DISPATCH_ALPHABET(d->nClasses, markReachableKernel, d, startNode, acyclic);
+}
+
+// Counts, then places, one predecessor entry per (state, column), the
+// sink included; offsets are shifted back after placement
+// Compte, puis place, une entre de prdcesseur par (tat, colonne), puits
+// compris ; les positions sont dcales aprs le placement
+DFA_ALWAYS_INLINE void buildInverseKernel(DfaMinimizer *d, const uint32_t k) {
+    uint32_t sink = d->nStates;
+    size_t slots = ((size_t)d->nStates + 1) * k;
+    uint32_t *predStart = xcalloc(slots + 1, sizeof(uint32_t));
+    uint32_t *preds = xcalloc(slots, sizeof(uint32_t));
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        const uint32_t *row = &d->transitions[(size_t)i * k];
+        for (uint32_t sym = 0; sym < k; ++sym) {
+            uint32_t t = row[sym] == DFA_NO_STATE ? sink : row[sym];
+            predStart[(size_t)t * k + sym + 1]++;
+        }
+    }
+    for (uint32_t sym = 0; sym < k; ++sym) predStart[(size_t)sink * k + sym + 1]++;
+    for (size_t i = 0; i < slots; ++i) predStart[i + 1] += predStart[i];
+
+    // predStart[slot] serves as the fill cursor, ending at the next slot's start
+    // predStart[slot] sert de curseur, et finit au dbut de la case suivante
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        const uint32_t *row = &d->transitions[(size_t)i * k];
+        for (uint32_t sym = 0; sym < k; ++sym) {
+            uint32_t t = row[sym] == DFA_NO_STATE ? sink : row[sym];
+            preds[predStart[(size_t)t * k + sym]++] = i;
+        }
+    }
+    for (uint32_t sym = 0; sym < k; ++sym) preds[predStart[(size_t)sink * k + sym]++] = sink;
+    memmove(predStart + 1, predStart, slots * sizeof(uint32_t));
+    predStart[0] = 0;
+
+    d->predStart = predStart;
+    d->preds = preds;
+}
+
+void dfaEnsureInverse(DfaMinimizer *d) {
+    if (d->predStart && d->edited.count == 0) return;
+    dropInverse(d);
+    DISPATCH_ALPHABET(d->nClasses, buildInverseKernel, d);
+    d->inverseStates = d->nStates;
+}
+
+// Marks the states that can reach a final state (backward BFS over the
+// inverse index), O(n + m)
+// Marque les tats qui mnent  un tat final (parcours arrire sur l'index
+// inverse), O(n + m)
+static void markCoReachable(DfaMinimizer *d) {
+    dfaEnsureInverse(d);
+    d->coReachable = xrealloc(d->coReachable, d->nStates, sizeof(bool));
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *queue = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    uint32_t head = 0, tail = 0;
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        d->coReachable[i] = isFinalState(d, i) || stateOutput(d, i) != 0;
+        if (d->coReachable[i]) queue[tail++] = i;
+    }
+
+    // The predecessors of t on all columns are one contiguous range
+    // Les prdcesseurs de t par toutes les colonnes forment une seule plage
+    while (head < tail) {
+        uint32_t t = queue[head++];
+        size_t slot = (size_t)t * d->nClasses;
+        for (uint32_t p = d->predStart[slot]; p < d->predStart[slot + d->nClasses]; ++p) {
+            if (!d->coReachable[d->preds[p]]) {
+                d->coReachable[d->preds[p]] = true;
+                queue[tail++] = d->preds[p];
+            }
+        }
+    }
+    arenaRelease(&d->scratch, mark);
+}
+
+// Removes the states not in keep, renumbering the others densely and
+// clearing transitions to removed states; returns the new id of startNode
+// Supprime les tats hors de keep, renumrote les autres et nettoie les
+// transitions vers les tats supprims ; renvoie le nouveau numro de startNode
+static uint32_t compactStates(DfaMinimizer *d, const bool *keep, uint32_t startNode) {
+    dropInverse(d);
+
+    // New id of every kept state
+    // Nouveau numro de chaque tat conserv
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *newId = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    uint32_t writeIndex = 0;
+    for (uint32_t readIndex = 0; readIndex < d->nStates; ++readIndex) {
+        newId[readIndex] = keep[readIndex] ? writeIndex++ : DFA_NO_STATE;
+    }
+
+    // Compact the arrays in place, renumbering targets and clearing
+    // transitions to removed states
+    // Compacte les tableaux sur place, renumrote les cibles et nettoie
+    // les transitions vers les tats supprims
+    for (uint32_t readIndex = 0; readIndex < d->nStates; ++readIndex) {
+        if (!keep[readIndex]) continue;
+        uint32_t w = newId[readIndex];
+        const uint32_t *src = &d->transitions[(size_t)readIndex * d->nClasses];
+        uint32_t *dst = &d->transitions[(size_t)w * d->nClasses];
+        for (uint32_t sym = 0; sym < d->nClasses; ++sym) {
+            dst[sym] = src[sym] == DFA_NO_STATE ? DFA_NO_STATE : newId[src[sym]];
+        }
+        setFinalState(d, w, isFinalState(d, readIndex));
+        if (d->outputs) d->outputs[w] = d->outputs[readIndex];
+        if (w != readIndex) memcpy(d->stateNames[w], d->stateNames[readIndex], sizeof(d->stateNames[w]));
+    }
+    for (uint32_t i = writeIndex; i < d->nStates; ++i) setFinalState(d, i, false);
+    uint32_t newStart = startNode < d->nStates ? newId[startNode] : DFA_NO_STATE;
+    d->nStates = writeIndex;
+
+    arenaRelease(&d->scratch, mark);
+    return newStart;
+}
+
+// Removes unreachable states from the DFA, and dead states (which cannot
+// reach a final state) when dropDead is set; the start state is always kept.
+// The inverse index is built once on the reachable part and serves both the
+// backward pass and the engines; it is rebuilt only if dead states go.
+// Returns the new id of startNode.
+// Supprime les tats inaccessibles de l'automate, et les tats morts (qui
+// ne mnent  aucun tat final) si dropDead est vrai ; l'tat initial est
+// toujours conserv. L'index inverse est construit une fois sur la partie
+// accessible et sert au parcours arrire comme aux moteurs ; il n'est
+// reconstruit que si des tats morts sont supprims. Renvoie le nouveau
+// numro de startNode.
+static uint32_t removeUnreachable(DfaMinimizer *d, uint32_t startNode, bool dropDead) {
+    bool acyclic;
+    markReachable(d, startNode, &acyclic);
+    startNode = compactStates(d, d->reachable, startNode);
+    dfaEnsureInverse(d);
+    d->acyclic = acyclic;
+    if (!dropDead) return startNode;
+
+    markCoReachable(d);
+    bool anyDead = false;
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        d->coReachable[i] = d->coReachable[i] || i == startNode;
+        anyDead = anyDead || !d->coReachable[i];
+    }
+    if (anyDead) {
+        // Removing states keeps an acyclic DFA acyclic
+        // Supprimer des tats garde un automate acyclique
+        startNode = compactStates(d, d->coReachable, startNode);
+        dfaEnsureInverse(d);
+        d->acyclic = acyclic;
+    }
+    return startNode;
+}
+
+uint32_t dfaOutputBlocks(const DfaMinimizer *d, const uint32_t *states, uint32_t count, uint32_t *blockOf,
+                         ScratchArena *scratch) {
+    // Without output classes: final states 0, the others 1
+    // Sans classes de sortie : tats finaux 0, les autres 1
+    if (!d->outputs) {
+        for (uint32_t i = 0; i < count; ++i) blockOf[i] = isFinalState(d, states ? states[i] : i) ? 0 : 1;
+        return 2;
+    }
+
+    // Groups by (finality, class) through an open-addressing table, numbered
+    // by first occurrence, then final groups are moved in front
+    // Groupes par (finalit, classe) dans une table  adressage ouvert,
+    // numrots par premire apparition, puis les groupes finaux passent devant
+    uint32_t tableSize = 16;
+    while (tableSize < 2 * (uint64_t)count) tableSize *= 2;
+    ArenaMark mark = arenaMark(scratch);
+    uint64_t *keys = arenaAlloc(scratch, tableSize, sizeof(uint64_t));
+    uint32_t *groups = arenaAlloc(scratch, tableSize, sizeof(uint32_t));
+    uint64_t *groupKey = arenaAlloc(scratch, count, sizeof(uint64_t));
+    memset(groups, 0xff, tableSize * sizeof(uint32_t));
+    uint32_t nGroups = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t s = states ? states[i] : i;
+        uint64_t key = (uint64_t)isFinalState(d, s) << 32 | (uint32_t)d->outputs[s];
+        uint32_t slot = (uint32_t)((key * UINT64_C(0x9e3779b97f4a7c15)) >> 32) & (tableSize - 1);
+        while (groups[slot] != DFA_NO_STATE && keys[slot] != key) slot = (slot + 1) & (tableSize - 1);
+        if (groups[slot] == DFA_NO_STATE) {
+            keys[slot] = key;
+            groupKey[nGroups] = key;
+            groups[slot] = nGroups++;
+        }
+        blockOf[i] = groups[slot];
+    }
+    uint32_t *rank = arenaAlloc(scratch, nGroups, sizeof(uint32_t));
+    uint32_t next = 0;
+    for (uint32_t g = 0; g < nGroups; ++g) if (groupKey[g] >> 32) rank[g] = next++;
+    for (uint32_t g = 0; g < nGroups; ++g) if (!(groupKey[g] >> 32)) rank[g] = next++;
+    for (uint32_t i = 0; i < count; ++i) blockOf[i] = rank[blockOf[i]];
+    arenaRelease(scratch, mark);
+    return nGroups;
+}
+
+// Creates initial partitions (final vs non-final states, then by output class)
+// Cre les partitions initiales (tats finaux vs non finaux, puis par classe de sortie)
+static void initialPartition(DfaMinimizer *d) {
+    // Final states come first; an empty group is dropped
+    // Les tats finaux viennent d'abord ; un groupe vide est omis
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *blockOf = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    uint32_t nBlocks = dfaOutputBlocks(d, NULL, d->nStates, blockOf, &d->scratch);
+    refinableInit(&d->partition, d->nStates, blockOf, nBlocks, &d->scratch);
+    arenaRelease(&d->scratch, mark);
+    stateSetClear(&d->changed);
+    d->refined = false;
+
+    if (d->trace) fprintf(d->trace, "Initial Partitions (%u):\n", d->partition.nBlocks);
+    printPartitions(d, false);
+}
+
+// Partition id reached from state s on symbol sym (-2 if no transition)
+// Partition atteinte depuis l'tat s par le symbole sym (-2 sans transition)
+DFA_ALWAYS_INLINE int32_t nextPartition(const DfaMinimizer *d, uint32_t s, uint32_t sym, const uint32_t k) {
+    uint32_t t = d->transitions[(size_t)s * k + sym];
+    return t == DFA_NO_STATE ? -2 : (int32_t)d->partition.sidx[t];
+}
+
+// Refines partitions until no more splits are possible
+// Raffine les partitions jusqu' ce qu'aucune division ne soit possible
+DFA_ALWAYS_INLINE void refineAllPartitionsKernel(DfaMinimizer *d, const uint32_t k) {
+    RefinablePartition *p = &d->partition;
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *reps = arenaAlloc(&d->scratch, p->nElems, sizeof(uint32_t));     // First state of each sub-block
+    uint32_t *newBlockOf = arenaAlloc(&d->scratch, p->nElems, sizeof(uint32_t));
+    bool changed;
+    do {
+        uint32_t nNext = 0;
+
+        // Split each block in turn: its sub-blocks are numbered by first
+        // state, after the sub-blocks of the blocks before it
+        // Divise chaque bloc  son tour : ses sous-blocs sont numrots par
+        // premier tat, aprs les sous-blocs des blocs prcdents
+        for (uint32_t b = 0; b < p->nBlocks; ++b) {
+            uint32_t nSub = 0;
+            for (uint32_t i = p->first[b]; i < p->end[b]; ++i) {
+                uint32_t s = p->elems[i];
+
+                // Compare s with the representative of each sub-block so far
+                // Compare s au reprsentant de chaque sous-bloc existant
+                uint32_t sub = 0;
+                for (; sub < nSub; ++sub) {
+                    bool distinguishable = false;
+                    for (uint32_t sym = 0; sym < k; ++sym) {
+                        if (nextPartition(d, s, sym, k) != nextPartition(d, reps[sub], sym, k)) {
+                            distinguishable = true;
+                            break;
+                        }
+                    }
+                    if (!distinguishable) break;
+                }
+                if (sub == nSub) reps[nSub++] = s;
+                newBlockOf[s] = nNext + sub;
+            }
+            nNext += nSub;
+        }
+
+        // Install the new blocks (ids unchanged when nothing was split)
+        // Installe les nouveaux blocs (numros inchangs si rien n'a t divis)
+        changed = nNext != p->nBlocks;
+        if (changed) {
+            refinableRegroup(p, newBlockOf, nNext, &d->scratch);
+            if (d->trace) fprintf(d->trace, "Partitions refined (%u total):\n", p->nBlocks);
+            printPartitions(d, false);
+        }
+    } while (changed);
+    arenaRelease(&d->scratch, mark);
+
+    if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", p->nBlocks);
+    printPartitions(d, true);
+}
+
+static void refineAllPartitions(DfaMinimizer *d) {
+    DISPATCH_ALPHABET(d->nClasses, refineAllPartitionsKernel, d);
+}
+
+// Rebuilds the partitions from a block id per state (ids below nBlocks),
+// numbering blocks by first occurrence in state order
+// Reconstruit les partitions  partir d'un numro de bloc par tat
+// (infrieur  nBlocks), numrots par premire apparition
+static void installBlocks(DfaMinimizer *d, const uint32_t *blockOf, uint32_t nBlocks) {
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *newId = arenaAlloc(&d->scratch, nBlocks, sizeof(uint32_t));
+    uint32_t *renumbered = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    for (uint32_t b = 0; b < nBlocks; ++b) newId[b] = DFA_NO_STATE;
+    uint32_t nNext = 0;
+    for (uint32_t i = 0; i < d->nStates; ++i) {
+        uint32_t b = blockOf[i];
+        if (newId[b] == DFA_NO_STATE) newId[b] = nNext++;
+        renumbered[i] = newId[b];
+    }
+    refinableInit(&d->partition, d->nStates, renumbered, nNext, &d->scratch);
+    arenaRelease(&d->scratch, mark);
+}
+
+// Hash of the Moore signature of s: its block and the blocks of its successors
+// Hachage de la signature de Moore de s : son bloc et ceux de ses successeurs
+DFA_ALWAYS_INLINE uint64_t signatureHash(const DfaMinimizer *d, uint32_t s, const uint32_t k) {
+    uint64_t h = (uint64_t)d->partition.sidx[s] * UINT64_C(0x9e3779b97f4a7c15);
+    for (uint32_t sym = 0; sym < k; ++sym) {
+        h = (h ^ (uint32_t)nextPartition(d, s, sym, k)) * UINT64_C(0x100000001b3);
+    }
+    return h ^ (h >> 29);
+}
+
+// Whether s and t have the same Moore signature
+// Indique si s et t ont la mme signature de Moore
+DFA_ALWAYS_INLINE bool sameSignature(const DfaMinimizer *d, uint32_t s, uint32_t t, const uint32_t k) {
+    if (d->partition.sidx[s] != d->partition.sidx[t]) return false;
+    for (uint32_t sym = 0; sym < k; ++sym) {
+        if (nextPartition(d, s, sym, k) != nextPartition(d, t, sym, k)) return false;
+    }
+    return true;
+}
+
+// Moore refinement where each round groups states by hashing their
+// signature instead of comparing them with every sub-block representative:
+// O(k n) per round however much a block fragments. Blocks are visited in
+// the same order as refineAllPartitions(), so the partitions, their
+// numbering and the trace are identical.
+// Raffinement de Moore o chaque passe regroupe les tats par hachage de
+// leur signature au lieu de les comparer au reprsentant de chaque
+// sous-bloc : O(k n) par passe quelle que soit la fragmentation. Les blocs
+// sont parcourus dans le mme ordre que refineAllPartitions() : partitions,
+// numrotation et trace sont identiques.
+DFA_ALWAYS_INLINE void refineSignatureKernel(DfaMinimizer *d, const uint32_t k) {
+    RefinablePartition *p = &d->partition;
+    uint32_t tableSize = 1;
+    while (tableSize < 2 * (uint64_t)p->nElems) tableSize *= 2;
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *table = arenaAlloc(&d->scratch, tableSize, sizeof(uint32_t));   // Signature -> new block
+    uint32_t *reps = arenaAlloc(&d->scratch, p->nElems, sizeof(uint32_t));    // First state of each new block
+    uint32_t *newBlockOf = arenaAlloc(&d->scratch, p->nElems, sizeof(uint32_t));
+    bool changed;
+    do {
+        uint32_t nNext = 0;
+        memset(table, 0xff, tableSize * sizeof(uint32_t));
+
+        // Signatures use the previous round's ids throughout the round
+        // Les signatures utilisent les numros de la passe prcdente
+        for (uint32_t i = 0; i < p->nElems; ++i) {
+            uint32_t s = p->elems[i];
+            uint32_t slot = (uint32_t)signatureHash(d, s, k) & (tableSize - 1);
+            uint32_t b;
+            while ((b = table[slot]) != DFA_NO_STATE && !sameSignature(d, s, reps[b], k)) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (b == DFA_NO_STATE) {
+                b = table[slot] = nNext;
+                reps[nNext++] = s;
+            }
+            newBlockOf[s] = b;
+        }
+
+        changed = nNext != p->nBlocks;
+        if (changed) {
+            refinableRegroup(p, newBlockOf, nNext, &d->scratch);
+            if (d->trace) fprintf(d->trace, "Partitions refined (%u total):\n", p->nBlocks);
+            printPartitions(d, false);
+        }
+    } while (changed);
+    arenaRelease(&d->scratch, mark);
+
+    if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", p->nBlocks);
+    printPartitions(d, true);
+}
+
+static void refineSignature(DfaMinimizer *d) {
+    DISPATCH_ALPHABET(d->nClasses, refineSignatureKernel, d);
+}
+
+// Moore refinement by sorting: each round orders the states by signature
+// with an LSD radix sort (one stable counting pass per digit, the digit
+// being a whole block id), then cuts the sorted order into runs of equal
+// signatures, which become the next blocks. Every step is a sequential
+// array pass; the partition is rebuilt only at the end.
+// Raffinement de Moore par tri : chaque passe ordonne les tats par
+// signature avec un tri par base LSD (un comptage stable par chiffre, le
+// chiffre tant un numro de bloc entier), puis dcoupe l'ordre obtenu en
+// suites de signatures gales, qui deviennent les blocs suivants. Chaque
+// tape est un parcours squentiel de tableaux ; la partition n'est
+// reconstruite qu' la fin.
+DFA_ALWAYS_INLINE void refineRadixKernel(DfaMinimizer *d, const uint32_t k) {
+    uint32_t n = d->nStates;
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *blockOf = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t *nextBlockOf = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t *order = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t *sorted = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t *digits = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t *count = arenaAlloc(&d->scratch, (size_t)n + 2, sizeof(uint32_t));
+    if (n) memcpy(blockOf, d->partition.sidx, n * sizeof(uint32_t));
+    uint32_t nBlocks = d->partition.nBlocks;
+
+    bool changed = n > 0;
+    while (changed) {
+        // Least significant digit first, ending with the block of the state
+        // Chiffre le moins significatif d'abord, en finissant par le bloc de l'tat
+        for (uint32_t i = 0; i < n; ++i) order[i] = i;
+        for (uint32_t digit = k + 1; digit-- > 0;) {
+            memset(count, 0, ((size_t)nBlocks + 2) * sizeof(uint32_t));
+            for (uint32_t s = 0; s < n; ++s) {
+                digits[s] = signatureDigit(d, blockOf, s, digit, k);
+                count[digits[s] + 1]++;
+            }
+            for (uint32_t b = 0; b <= nBlocks; ++b) count[b + 1] += count[b];
+            for (uint32_t i = 0; i < n; ++i) {
+                uint32_t s = order[i];
+                sorted[count[digits[s]]++] = s;
+            }
+            uint32_t *swap = order; order = sorted; sorted = swap;
+        }
+
+        // Runs of equal signatures become the new blocks
+        // Les suites de signatures gales deviennent les nouveaux blocs
+        uint32_t nNext = 1;
+        nextBlockOf[order[0]] = 0;
+        for (uint32_t i = 1; i < n; ++i) {
+            uint32_t s = order[i], prev = order[i - 1];
+            for (uint32_t digit = 0; digit <= k; ++digit) {
+                if (signatureDigit(d, blockOf, s, digit, k) != signatureDigit(d, blockOf, prev, digit, k)) {
+                    nNext++;
+                    break;
+                }
+            }
+            nextBlockOf[s] = nNext - 1;
+        }
+        changed = nNext != nBlocks;
+        uint32_t *swap = blockOf; blockOf = nextBlockOf; nextBlockOf = swap;
+        nBlocks = nNext;
+    }
+
+    installBlocks(d, blockOf, nBlocks);
+    if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", d->partition.nBlocks);
+    printPartitions(d, true);
+
+    arenaRelease(&d->scratch, mark);
+}
+
+static void refineRadix(DfaMinimizer *d) {
+    DISPATCH_ALPHABET(d->nClasses, refineRadixKernel, d);
+}
+
+// Refines partitions with Hopcroft's algorithm (splitter worklist, smaller half)
+// Raffine les partitions avec l'algorithme de Hopcroft (liste de sparateurs, plus petite moiti)
+//
+// Missing transitions lead to a virtual sink kept in its own block, so the
+// result is exactly the partition computed by refineAllPartitions().
+// Les transitions absentes mnent  un puits virtuel gard dans son propre
+// bloc : le rsultat est exactement la partition de refineAllPartitions().
+DFA_ALWAYS_INLINE void refineHopcroftKernel(DfaMinimizer *d, const uint32_t k) {
+    uint32_t n = d->nStates + 1;      // Real states plus the virtual sink
+    uint32_t sink = d->nStates;
+    size_t slots = (size_t)n * k;
+
+    // Predecessors of (target, sym), sink included, from the shared index
+    // Prdcesseurs de (cible, sym), puits compris, depuis l'index partag
+    dfaEnsureInverse(d);
+    const uint32_t *predStart = d->predStart;
+    const uint32_t *preds = d->preds;
+
+    // Current blocks plus the virtual sink in a block of its own
+    // Blocs courants plus le puits virtuel dans son propre bloc
+    RefinablePartition P = { 0 };
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *buffer = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    if (d->nStates) memcpy(buffer, d->partition.sidx, d->nStates * sizeof(uint32_t));
+    buffer[sink] = d->partition.nBlocks;
+    refinableInit(&P, n, buffer, d->partition.nBlocks + 1, &d->scratch);
+
+    // Worklist of (block, symbol) splitters: every initial block but the largest
+    // Liste de sparateurs (bloc, symbole) : tous les blocs initiaux sauf le plus grand
+    size_t *work = arenaAlloc(&d->scratch, slots, sizeof(size_t));
+    size_t nWork = 0;
+    uint32_t largest = 0;
+    for (uint32_t b = 1; b < P.nBlocks; ++b) {
+        if (P.end[b] - P.first[b] > P.end[largest] - P.first[largest]) largest = b;
+    }
+    for (uint32_t b = 0; b < P.nBlocks; ++b) {
+        if (b == largest) continue;
+        for (uint32_t sym = 0; sym < k; ++sym) work[nWork++] = (size_t)b * k + sym;
+    }
+
+    while (nWork > 0) {
+        size_t splitter = work[--nWork];
+        uint32_t A = (uint32_t)(splitter / k);
+        uint32_t sym = (uint32_t)(splitter % k);
+
+        // Collect the preimage of A on sym before touching the block layout
+        // Collecte la primage de A par sym avant de modifier les blocs
+        uint32_t nPre = 0;
+        for (uint32_t e = P.first[A]; e < P.end[A]; ++e) {
+            size_t slot = (size_t)P.elems[e] * k + sym;
+            for (uint32_t p = predStart[slot]; p < predStart[slot + 1]; ++p) buffer[nPre++] = preds[p];
+        }
+        for (uint32_t p = 0; p < nPre; ++p) refinableMark(&P, buffer[p], P.touched, &P.nTouched);
+
+        // Split touched blocks, the smaller half becoming a new block
+        // Divise les blocs touchs, la plus petite moiti devenant un nouveau bloc
+        while (P.nTouched > 0) {
+            uint32_t b = P.touched[--P.nTouched];
+            if (!refinableSplit(&P, b, P.nBlocks)) continue;
+            uint32_t z = P.nBlocks++;
+
+            // Whether or not (b, c) is pending, adding (z, c) keeps the worklist complete
+            // Que (b, c) soit en attente ou non, ajouter (z, c) garde la liste complte
+            for (uint32_t c = 0; c < k; ++c) work[nWork++] = (size_t)z * k + c;
+        }
+    }
+
+    installBlocks(d, P.sidx, P.nBlocks);
+    if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", d->partition.nBlocks);
+    printPartitions(d, true);
+
+    arenaRelease(&d->scratch, mark);
+    refinableFree(&P);
+}
+
+static void refineHopcroft(DfaMinimizer *d) {
+    DISPATCH_ALPHABET(d->nClasses, refineHopcroftKernel, d);
+}
+
+// Revuz's minimization of an acyclic DFA: states are visited successors
+// first (Kahn's order over the inverse index), and each joins the block of
+// an earlier state with the same signature (its current block and the new
+// blocks of its successors) or opens a new one. Successors are settled by
+// then, so one pass suffices: O(k n). Returns false, leaving the partition
+// untouched, if the DFA has a cycle.
+// Minimisation de Revuz d'un automate acyclique : les tats sont visits
+// successeurs d'abord (ordre de Kahn sur l'index inverse), et chacun
+// rejoint le bloc d'un tat antrieur de mme signature (son bloc courant
+// et les nouveaux blocs de ses successeurs) ou en ouvre un nouveau. Les
+// successeurs sont alors fixs : une passe suffit, O(k n). Renvoie false,
+// sans toucher  la partition, si l'automate a un cycle.
+DFA_ALWAYS_INLINE void refineRevuzKernel(DfaMinimizer *d, bool *done, const uint32_t k) {
+    uint32_t n = d->nStates;
+    dfaEnsureInverse(d);
+
+    // pending[s] counts the transitions of s to states not yet ordered
+    // pending[s] compte les transitions de s vers des tats pas encore ordonns
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *pending = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t *order = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t tail = 0;
+    for (uint32_t s = 0; s < n; ++s) {
+        const uint32_t *row = &d->transitions[(size_t)s * k];
+        for (uint32_t sym = 0; sym < k; ++sym) pending[s] += row[sym] != DFA_NO_STATE;
+        if (pending[s] == 0) order[tail++] = s;
+    }
+    for (uint32_t head = 0; head < tail; ++head) {
+        size_t slot = (size_t)order[head] * k;
+        for (uint32_t p = d->predStart[slot]; p < d->predStart[slot + k]; ++p) {
+            if (--pending[d->preds[p]] == 0) order[tail++] = d->preds[p];
+        }
+    }
+    *done = tail == n;
+    if (!*done) {
+        arenaRelease(&d->scratch, mark);
+        return;
+    }
+
+    uint32_t tableSize = 1;
+    while (tableSize < 2 * (uint64_t)n) tableSize *= 2;
+    uint32_t *table = arenaAlloc(&d->scratch, tableSize, sizeof(uint32_t));   // Signature -> block
+    memset(table, 0xff, tableSize * sizeof(uint32_t));
+    uint32_t *reps = arenaAlloc(&d->scratch, n, sizeof(uint32_t));            // First state of each block
+    uint32_t *blockOf = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint32_t nBlocks = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t s = order[i];
+        const uint32_t *row = &d->transitions[(size_t)s * k];
+        uint64_t h = (uint64_t)d->partition.sidx[s] * UINT64_C(0x9e3779b97f4a7c15);
+        for (uint32_t sym = 0; sym < k; ++sym) {
+            uint32_t b = row[sym] == DFA_NO_STATE ? DFA_NO_STATE : blockOf[row[sym]];
+            h = (h ^ b) * UINT64_C(0x100000001b3);
+        }
+        uint32_t slot = (uint32_t)(h ^ (h >> 29)) & (tableSize - 1);
+        uint32_t b;
+        while ((b = table[slot]) != DFA_NO_STATE) {
+            const uint32_t *other = &d->transitions[(size_t)reps[b] * k];
+            bool same = d->partition.sidx[s] == d->partition.sidx[reps[b]];
+            for (uint32_t sym = 0; same && sym < k; ++sym) {
+                same = row[sym] == DFA_NO_STATE ? other[sym] == DFA_NO_STATE
+                                                : other[sym] != DFA_NO_STATE && blockOf[row[sym]] == blockOf[other[sym]];
+            }
+            if (same) break;
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (b == DFA_NO_STATE) {
+            b = table[slot] = nBlocks;
+            reps[nBlocks++] = s;
+        }
+        blockOf[s] = b;
+    }
+
+    installBlocks(d, blockOf, nBlocks);
+    if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", d->partition.nBlocks);
+    printPartitions(d, true);
+
+    arenaRelease(&d->scratch, mark);
+}
+
+static bool refineRevuz(DfaMinimizer *d) {
+    bool done;
+    DISPATCH_ALPHABET(d->nClasses, refineRevuzKernel, d, &done);
+    return done;
+}
+
+DfaStatus dfaTrim(DfaMinimizer *d, bool dropDead) {
+    if (d->initialState == DFA_NO_STATE) return DFA_ERR_INVALID;
+    dropSpareClasses(d);
+    d->initialState = removeUnreachable(d, d->initialState, dropDead);
+    refinableFree(&d->partition);
+    stateSetClear(&d->changed);
+    d->refined = false;
+    return DFA_OK;
+}
+
+DfaStatus dfaInitialPartition(DfaMinimizer *d) {
+    initialPartition(d);
+    return DFA_OK;
+}
+
+// Refines the current partition with the given engine
+// Raffine la partition courante avec le moteur donn
+static DfaStatus refinePartition(DfaMinimizer *d, DfaEngine engine) {
+    // Any engine would find the same partition: acyclic DFAs take the linear path
+    // Tout moteur trouverait la mme partition : les automates acycliques prennent la voie linaire
+    if ((d->acyclic || engine == DFA_ENGINE_REVUZ) && refineRevuz(d)) return DFA_OK;
+    switch (engine) {
+    case DFA_ENGINE_MOORE:     refineAllPartitions(d); return DFA_OK;
+    case DFA_ENGINE_HOPCROFT:
+    case DFA_ENGINE_REVUZ:     refineHopcroft(d); return DFA_OK;   // Revuz met a cycle / Revuz a rencontr un cycle
+    case DFA_ENGINE_SIGNATURE: refineSignature(d); return DFA_OK;
+    case DFA_ENGINE_RADIX:     refineRadix(d); return DFA_OK;
+    case DFA_ENGINE_PARALLEL_MOORE:
+    case DFA_ENGINE_PARALLEL_HOPCROFT:
+    case DFA_ENGINE_BRZOZOWSKI: {
+        if (engine == DFA_ENGINE_PARALLEL_HOPCROFT) dfaEnsureInverse(d);
+        ArenaMark mark = arenaMark(&d->scratch);
+        uint32_t *blockOf = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+        uint32_t nBlocks = engine == DFA_ENGINE_PARALLEL_MOORE     ? dfaParallelMooreBlocks(d, blockOf)
+                         : engine == DFA_ENGINE_PARALLEL_HOPCROFT ? dfaParallelHopcroftBlocks(d, blockOf)
+                                                                   : dfaBrzozowskiBlocks(d, blockOf);
+        if (nBlocks == 0 && d->nStates > 0) {
+            // The double reversal outgrew its budget: Hopcroft numbers blocks the same way
+            // La double inversion a dpass son budget : Hopcroft numrote les blocs de mme
+            arenaRelease(&d->scratch, mark);
+            return refinePartition(d, DFA_ENGINE_HOPCROFT);
+        }
+        installBlocks(d, blockOf, nBlocks);
+        arenaRelease(&d->scratch, mark);
+        if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", d->partition.nBlocks);
+        printPartitions(d, true);
+        return DFA_OK;
+    }
+    }
+    return DFA_ERR_INVALID;
+}
+
+DfaStatus dfaRefine(DfaMinimizer *d, DfaEngine engine) {
+    // The partition must cover every state (states added since are rejected)
+    // La partition doit couvrir tous les tats (sinon, des tats ont t ajouts)
+    if (d->partition.nElems != d->nStates) return DFA_ERR_INVALID;
+
+    // Only a partition refined with no edit pending is the coarsest one
+    // Seule une partition raffine sans modification en attente est la plus grossire
+    bool upToDate = d->changed.count == 0;
+    DfaStatus status = refinePartition(d, engine);
+    d->refined = status == DFA_OK && upToDate;
+    return status;
+}
+
+DfaStatus dfaReminimize(DfaMinimizer *d) {
+    // Without a refined partition to start from, minimize from scratch
+    // Sans partition raffine comme point de dpart, minimise depuis zro
+    if (!d->refined) return dfaMinimize(d, DFA_ENGINE_HOPCROFT);
+    if (d->changed.count == 0) return DFA_OK;
+
+    // A stale index serves as long as few rows changed since it was built
+    // Un index prim sert tant que peu de lignes ont chang depuis sa construction
+    if (!d->predStart || 8 * (uint64_t)d->edited.count > d->nStates) dfaEnsureInverse(d);
+    ArenaMark mark = arenaMark(&d->scratch);
+    uint32_t *blockOf = arenaAlloc(&d->scratch, d->nStates, sizeof(uint32_t));
+    uint32_t nBlocks = dfaIncrementalBlocks(d, blockOf);
+    if (nBlocks == 0) {
+        // Open cycles left to a full refinement
+        // Cycles ouverts laisss  un raffinement complet
+        arenaRelease(&d->scratch, mark);
+        return dfaMinimize(d, DFA_ENGINE_HOPCROFT);
+    }
+    installBlocks(d, blockOf, nBlocks);
+    arenaRelease(&d->scratch, mark);
+    stateSetClear(&d->changed);
+
+    if (d->trace) fprintf(d->trace, "\nFinal Partitions after refinement (%u):\n", d->partition.nBlocks);
+    printPartitions(d, true);
+    return DFA_OK;
+}
+
+DfaStatus dfaMinimize(DfaMinimizer *d, DfaEngine engine) {
+    DfaStatus status = dfaInitialPartition(d);
+    return status == DFA_OK ? dfaRefine(d, engine) : status;
+}
+
+DfaMinimizer *dfaQuotient(const DfaMinimizer *d) {
+    const RefinablePartition *p = &d->partition;
+    if (p->nBlocks == 0 || p->nElems != d->nStates) return NULL;
+    DfaMinimizer *q = dfaCreate(d->alphabetSize);
+    q->nClasses = d->nClasses;
+    q->spareClasses = d->spareClasses;
+    if (d->intervalClass) {
+        q->nIntervals = d->nIntervals;
+        q->intervalStart = xcalloc(d->nIntervals, sizeof(uint32_t));
+        q->intervalClass = xcalloc(d->nIntervals, sizeof(uint32_t));
+        memcpy(q->intervalStart, d->intervalStart, d->nIntervals * sizeof(uint32_t));
+        memcpy(q->intervalClass, d->intervalClass, d->nIntervals * sizeof(uint32_t));
+    }
+    dfaAddStates(q, p->nBlocks);
+
+    // One state per block, taking the row of its first state
+    // Un tat par bloc, avec la ligne de son premier tat
+    for (uint32_t i = 0; i < p->nBlocks; ++i) {
+        uint32_t rep = p->elems[p->first[i]];
+        const uint32_t *src = &d->transitions[(size_t)rep * d->nClasses];
+        uint32_t *dst = &q->transitions[(size_t)i * q->nClasses];
+        for (uint32_t c = 0; c < d->nClasses; ++c) {
+            dst[c] = src[c] == DFA_NO_STATE ? DFA_NO_STATE : p->sidx[src[c]];
+        }
+        setFinalState(q, (uint32_t)i, isFinalState(d, rep));
+        if (stateOutput(d, rep) != 0) dfaSetOutput(q, (uint32_t)i, stateOutput(d, rep));
+    }
+    if (d->initialState < d->nStates) q->initialState = p->sidx[d->initialState];
+    return q;
+}
+
+uint32_t dfaAlphabetSize(const DfaMinimizer *d) {
+    return d->alphabetSize;
+}
+
+uint32_t dfaStateCount(const DfaMinimizer *d) {
+    return d->nStates;
+}
+
+uint32_t dfaInitialState(const DfaMinimizer *d) {
+    return d->initialState;
+}
+
+bool dfaIsFinal(const DfaMinimizer *d, uint32_t state) {
+    return state < d->nStates && isFinalState(d, state);
+}
+
+int32_t dfaOutput(const DfaMinimizer *d, uint32_t state) {
+    return state < d->nStates ? stateOutput(d, state) : 0;
+}
+
+uint32_t dfaTransition(const DfaMinimizer *d, uint32_t state, int sym) {
+    if (state >= d->nStates || sym < 0 || (uint32_t)sym >= d->alphabetSize) return DFA_NO_STATE;
+    return d->transitions[(size_t)state * d->nClasses + symbolColumn(d, (uint32_t)sym)];
+}
+
+bool dfaIsAcyclic(const DfaMinimizer *d) {
+    return d->acyclic;
+}
+
+const char *dfaStateName(const DfaMinimizer *d, uint32_t state) {
+    return state < d->nStates ? d->stateNames[state] : NULL;
+}
+
+int dfaPartitionCount(const DfaMinimizer *d) {
+    return (int)d->partition.nBlocks;
+}
+
+int32_t dfaPartitionOf(const DfaMinimizer *d, uint32_t state) {
+    return state < d->nStates && state < d->partition.nElems ? (int32_t)d->partition.sidx[state] : -1;
+}
+
+const uint32_t *dfaPartitionStates(const DfaMinimizer *d, int partition, uint32_t *count) {
+    const RefinablePartition *p = &d->partition;
+    if (partition < 0 || (uint32_t)partition >= p->nBlocks) {
+        if (count) *count = 0;
+        return NULL;
+    }
+    if (count) *count = p->end[partition] - p->first[partition];
+    return &p->elems[p->first[partition]];
+}
@@ -0,0 +1,454 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#ifndef DFA_MINIMIZER_H
+#define DFA_MINIMIZER_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DFA_NO_STATE UINT32_MAX    // Missing transition / Transition absente
+
+// Opaque minimizer context: one DFA and its partitions, no shared state.
+// Independent contexts may be used concurrently from different threads.
+// Contexte opaque du minimiseur : un automate et ses partitions, sans tat
+// partag. Des contextes distincts peuvent tre utiliss en parallle.
+typedef struct DfaMinimizer DfaMinimizer;
+
+// Result codes returned by the API
+// Codes de retour de l'API
+typedef enum {
+    DFA_OK = 0,
+    DFA_ERR_INVALID = -1,  // Bad state id, symbol or call order
+    DFA_ERR_FORMAT = -2,   // Malformed input file / Fichier d'entre mal form
+    DFA_ERR_IO = -3        // Read or write failure / chec de lecture ou d'criture
+} DfaStatus;
+
+// Refinement engines
+// Moteurs de raffinement
+typedef enum {
+    DFA_ENGINE_MOORE,      // Round-by-round refinement / Raffinement par passes
+    DFA_ENGINE_HOPCROFT,   // Splitter worklist, O(k n log n) / Liste de sparateurs
+    DFA_ENGINE_SIGNATURE,  // Moore rounds with hashed signatures, O(k n) per round
+                           // Passes de Moore par signatures haches, O(k n) par passe
+    DFA_ENGINE_RADIX,      // Moore rounds by LSD radix sort of signatures, O(k n) per round
+                           // Passes de Moore par tri par base des signatures
+    DFA_ENGINE_PARALLEL_MOORE,    // Multithreaded signature rounds (see dfaSetThreads)
+                                  // Passes par signatures multithreades
+    DFA_ENGINE_PARALLEL_HOPCROFT, // Hopcroft with batches of splitters split across threads
+                                  // Hopcroft par lots de sparateurs rpartis entre threads
+    DFA_ENGINE_BRZOZOWSKI,        // Reverse and determinize twice, from the output groups;
+                                  // falls back to Hopcroft when the subsets blow up
+                                  // Double renversement et dterminisation ; cde  Hopcroft
+                                  // si les sous-ensembles explosent
+    DFA_ENGINE_REVUZ              // Acyclic DFAs in one pass, successors first; Hopcroft on a cycle
+                                  // Automates acycliques en une passe, successeurs d'abord ;
+                                  // Hopcroft en cas de cycle
+} DfaEngine;
+
+// Creates an empty DFA over symbols 0..alphabetSize-1 (NULL if alphabetSize
+// is 0); allocation failures abort the process. Sizes 2, 4 and 256 use
+// specialized kernels, any other size runs the generic ones.
+// Cre un automate vide sur les symboles 0..alphabetSize-1 (NULL si
+// alphabetSize vaut 0) ; un chec d'allocation termine le processus. Les
+// tailles 2, 4 et 256 ont des noyaux spcialiss, les autres le cas gnral.
+DfaMinimizer *dfaCreate(uint32_t alphabetSize);
+
+// Releases a context and everything it owns
+// Libre un contexte et tout ce qu'il possde
+void dfaDestroy(DfaMinimizer *dfa);
+
+// Sends the step-by-step partition trace to out (NULL disables it)
+// Envoie la trace des partitions vers out (NULL la dsactive)
+void dfaSetTrace(DfaMinimizer *dfa, FILE *out);
+
+// Number of threads used by the parallel engines (0: one per online CPU).
+// Their result does not depend on it.
+// Nombre de threads des moteurs parallles (0 : un par processeur). Leur
+// rsultat n'en dpend pas.
+void dfaSetThreads(DfaMinimizer *dfa, int nThreads);
+
+// Adds a state (name: 3 chars max, may be NULL) and returns its id
+// Ajoute un tat (nom : 3 caractres max, peut tre NULL) et renvoie son numro
+uint32_t dfaAddState(DfaMinimizer *dfa, const char *name, bool isFinal);
+
+// Adds count unnamed non-final states without transitions and returns the
+// id of the first one (DFA_NO_STATE if count is 0 or too large)
+// Ajoute count tats anonymes non finaux sans transitions et renvoie le
+// numro du premier (DFA_NO_STATE si count vaut 0 ou est trop grand)
+uint32_t dfaAddStates(DfaMinimizer *dfa, uint32_t count);
+
+// Marks a state as final or not
+// Marque un tat comme final ou non
+DfaStatus dfaSetFinal(DfaMinimizer *dfa, uint32_t state, bool isFinal);
+
+// Gives a state an output class (0 by default), turning the DFA into a Moore
+// machine: minimization then merges only states with equal finality and
+// output classes, and dead-state removal keeps states with a non-zero class.
+// A Mealy machine is minimized by moving each transition output onto a state
+// per (target, output) pair.
+// Donne  un tat une classe de sortie (0 par dfaut), faisant de
+// l'automate une machine de Moore : la minimisation ne fusionne alors que
+// des tats de mme finalit et de mme classe, et la suppression des tats
+// morts garde ceux de classe non nulle. Une machine de Mealy se minimise en
+// reportant chaque sortie de transition sur un tat par couple (cible,
+// sortie).
+DfaStatus dfaSetOutput(DfaMinimizer *dfa, uint32_t state, int32_t output);
+
+// Sets the transition from on sym (to == DFA_NO_STATE removes it)
+// Dfinit la transition de from par sym (to == DFA_NO_STATE la supprime)
+DfaStatus dfaSetTransition(DfaMinimizer *dfa, uint32_t from, int sym, uint32_t to);
+
+// Sets the transitions from on every symbol lo..hi in one edit: on a
+// compressed alphabet the cost follows the number of intervals the range
+// covers, not its width, which suits Unicode-sized alphabets
+// Dfinit en une modification les transitions de from par chaque symbole
+// lo..hi : sur un alphabet compress le cot suit le nombre d'intervalles
+// couverts, non la largeur de la plage, ce qui convient aux alphabets de la
+// taille d'Unicode
+DfaStatus dfaSetTransitionRange(DfaMinimizer *dfa, uint32_t from, int lo, int hi, uint32_t to);
+
+// One edit of dfaSetTransitionRanges(): from on lo..hi goes to to
+// Une modification de dfaSetTransitionRanges() : from par lo..hi va vers to
+typedef struct {
+    uint32_t from;
+    int      lo, hi;
+    uint32_t to;
+} DfaRangeEdit;
+
+// Applies count range edits as if one after the other, in one pass: on a
+// compressed alphabet every boundary is cut and the columns rebuilt once,
+// in O((I + E) log(I + E) + n C) for I intervals, E edits and C classes,
+// instead of one table update per edit. When conflict is not NULL, an edit
+// giving a (source, symbol) a target other than the one it already has
+// (in the DFA or from an earlier edit; DFA_NO_STATE has none) is refused:
+// the DFA is left unchanged, *conflict receives the smallest such index and
+// DFA_ERR_INVALID is returned. An invalid edit is reported the same way,
+// and count if the rebuilt table would not fit.
+// Applique count modifications de plages comme l'une aprs l'autre, en une
+// passe : sur un alphabet compress toutes les bornes sont coupes et les
+// colonnes reconstruites une fois, en O((I + E) log(I + E) + n C) pour I
+// intervalles, E modifications et C classes, au lieu d'une mise  jour de
+// la table par modification. Si conflict n'est pas NULL, une modification
+// donnant  un (source, symbole) une cible autre que celle qu'il a dj
+// (dans l'automate ou par une modification antrieure ; DFA_NO_STATE n'en
+// est pas une) est refuse : l'automate reste inchang, *conflict reoit le
+// plus petit tel indice et DFA_ERR_INVALID est renvoy. Une modification
+// invalide est signale de mme, et count si la table reconstruite ne
+// tiendrait pas.
+DfaStatus dfaSetTransitionRanges(DfaMinimizer *dfa, const DfaRangeEdit *edits, size_t count, size_t *conflict);
+
+// Removes every transition into and out of state and makes it non-final
+// with output class 0, in time proportional to its in-degree; the id stays,
+// unreachable, until the next dfaTrim(). The initial state cannot be removed.
+// Supprime toutes les transitions entrant dans state et en sortant et le
+// rend non final de classe de sortie 0, en temps proportionnel  son degr
+// entrant ; le numro reste, inaccessible, jusqu'au prochain dfaTrim().
+// L'tat initial ne peut pas tre supprim.
+DfaStatus dfaRemoveState(DfaMinimizer *dfa, uint32_t state);
+
+// Selects the initial state (state 0 by default)
+// Choisit l'tat initial (l'tat 0 par dfaut)
+DfaStatus dfaSetInitial(DfaMinimizer *dfa, uint32_t state);
+
+// Merges symbols whose columns are identical in every state into classes,
+// so that trimming and refinement loop over classes instead of symbols; the
+// alphabet is then kept as sorted intervals of consecutive symbols sharing a
+// class. Queries still take symbols; an edit that would split a class gives
+// the edited range a column of its own. Compressing before adding states
+// starts from a single class, so huge alphabets never need one column per
+// symbol.
+// Fusionne en classes les symboles dont les colonnes sont identiques pour
+// tous les tats : nettoyage et raffinement parcourent alors les classes ;
+// l'alphabet est ensuite gard en intervalles tris de symboles conscutifs
+// de mme classe. Les requtes prennent toujours des symboles ; une
+// modification qui sparerait une classe donne  la plage modifie sa propre
+// colonne. Compresser avant d'ajouter des tats part d'une seule classe, si
+// bien que les trs grands alphabets n'ont jamais une colonne par symbole.
+DfaStatus dfaCompressAlphabet(DfaMinimizer *dfa);
+
+// Restores one table column per symbol
+// Rtablit une colonne de la table par symbole
+DfaStatus dfaExpandAlphabet(DfaMinimizer *dfa);
+
+// Number of table columns, and the column of sym (DFA_NO_STATE if invalid)
+// Nombre de colonnes de la table, et colonne de sym (DFA_NO_STATE si invalide)
+uint32_t dfaClassCount(const DfaMinimizer *dfa);
+uint32_t dfaSymbolClass(const DfaMinimizer *dfa, int sym);
+
+// Last symbol of the interval holding sym (sym itself while uncompressed,
+// -1 if invalid): walking sym = dfaIntervalEnd(dfa, sym) + 1 visits each
+// interval once
+// Dernier symbole de l'intervalle contenant sym (sym lui-mme sans
+// compression, -1 si invalide) : avancer par sym = dfaIntervalEnd(dfa, sym) + 1
+// visite chaque intervalle une fois
+int dfaIntervalEnd(const DfaMinimizer *dfa, int sym);
+
+// Removes unreachable states, and dead states when dropDead is set;
+// state ids are renumbered densely. The walk also detects whether the
+// remaining DFA is acyclic, in which case dfaRefine() uses DFA_ENGINE_REVUZ
+// whatever the engine asked for (until the next edit).
+// Supprime les tats inaccessibles, et les tats morts si dropDead est vrai ;
+// les numros d'tats sont recompacts. Le parcours dtecte aussi si
+// l'automate restant est acyclique : dfaRefine() emploie alors
+// DFA_ENGINE_REVUZ quel que soit le moteur demand (jusqu' la prochaine
+// modification).
+DfaStatus dfaTrim(DfaMinimizer *dfa, bool dropDead);
+
+// Builds the initial final / non-final partition
+// Construit la partition initiale finaux / non finaux
+DfaStatus dfaInitialPartition(DfaMinimizer *dfa);
+
+// Refines the current partition with the given engine
+// Raffine la partition courante avec le moteur donn
+DfaStatus dfaRefine(DfaMinimizer *dfa, DfaEngine engine);
+
+// Initial partition followed by refinement
+// Partition initiale suivie du raffinement
+DfaStatus dfaMinimize(DfaMinimizer *dfa, DfaEngine engine);
+
+// Brings the partition up to date after edits made since the last
+// dfaMinimize() / dfaReminimize() (added states, dfaSetTransition(),
+// dfaSetFinal(), dfaSetOutput(), dfaRemoveState()). Only the states that
+// can reach an edited state are re-refined, next to the blocks they lead
+// to, and their new classes matched against the old blocks, so the
+// refinement work follows the size of the change; the partition is then
+// renumbered in one linear pass, as dfaRefine() would number it. Without a refined
+// partition, or when new classes form cycles of their own that outside
+// states could match, minimizes from scratch with DFA_ENGINE_HOPCROFT.
+// Met la partition  jour aprs les modifications faites depuis le
+// dernier dfaMinimize() / dfaReminimize() (tats ajouts,
+// dfaSetTransition(), dfaSetFinal(), dfaSetOutput(), dfaRemoveState()).
+// Seuls les tats qui mnent  un tat modifi sont raffins  nouveau,
+// avec les blocs qu'ils atteignent, et leurs nouvelles classes compares
+// aux anciens blocs : le travail de raffinement suit la taille de la
+// modification ; la partition est ensuite renumrote en un parcours
+// linaire, comme dfaRefine() la numroterait. Sans partition raffine, ou si de nouvelles
+// classes forment entre elles des cycles que des tats extrieurs
+// pourraient galer, minimise depuis zro avec DFA_ENGINE_HOPCROFT.
+DfaStatus dfaReminimize(DfaMinimizer *dfa);
+
+// Builds the minimized DFA as a new context: state i is partition i, left
+// unnamed (valid after dfaInitialPartition / dfaRefine, NULL otherwise)
+// Construit l'automate minimis dans un nouveau contexte : l'tat i est la
+// partition i, sans nom (valide aprs dfaInitialPartition / dfaRefine)
+DfaMinimizer *dfaQuotient(const DfaMinimizer *dfa);
+
+// Queries on the DFA
+// Requtes sur l'automate
+uint32_t    dfaAlphabetSize(const DfaMinimizer *dfa);
+uint32_t    dfaStateCount(const DfaMinimizer *dfa);
+uint32_t    dfaInitialState(const DfaMinimizer *dfa);
+bool        dfaIsFinal(const DfaMinimizer *dfa, uint32_t state);
+int32_t     dfaOutput(const DfaMinimizer *dfa, uint32_t state);
+uint32_t    dfaTransition(const DfaMinimizer *dfa, uint32_t state, int sym);
+const char *dfaStateName(const DfaMinimizer *dfa, uint32_t state);
+
+// Whether the last dfaTrim() found no cycle (false after any edit)
+// Indique si le dernier dfaTrim() n'a trouv aucun cycle (faux aprs toute modification)
+bool        dfaIsAcyclic(const DfaMinimizer *dfa);
+
+// Queries on the partition (valid after dfaInitialPartition / dfaRefine)
+// Requtes sur la partition (valides aprs dfaInitialPartition / dfaRefine)
+int             dfaPartitionCount(const DfaMinimizer *dfa);
+int32_t         dfaPartitionOf(const DfaMinimizer *dfa, uint32_t state);
+const uint32_t *dfaPartitionStates(const DfaMinimizer *dfa, int partition, uint32_t *count);
+
+// Decides whether a and b (same alphabet size) accept the same language,
+// and agree on output classes, with Hopcroft-Karp union-find over their
+// states, in near-linear time and without minimizing either side; missing
+// transitions lead to a non-final sink. *equal receives the answer. When
+// word and length are given and the DFAs differ, *word receives a shortest
+// distinguishing word (to free()) and *length its length, possibly 0;
+// otherwise *word is NULL.
+// Indique si a et b (mme taille d'alphabet) acceptent le mme langage, et
+// s'accordent sur les classes de sortie, par union-find de Hopcroft-Karp
+// sur leurs tats, en temps quasi linaire et sans minimiser aucun des
+// deux ; les transitions absentes mnent  un puits non final. *equal
+// reoit la rponse. Si word et length sont donns et que les automates
+// diffrent, *word reoit un mot distinguant le plus court ( librer par
+// free()) et *length sa longueur, ventuellement 0 ; sinon *word vaut NULL.
+DfaStatus dfaEquivalent(const DfaMinimizer *a, const DfaMinimizer *b, bool *equal, int **word, size_t *length);
+
+// Reads a DFA in the text format below from in, streaming it through a
+// fixed-size buffer into the transition table; memory besides the DFA
+// stays bounded. Alphabets of 65536 symbols or more are compressed, their
+// ranges applied by dfaSetTransitionRanges() in chunks of at most 65536.
+// On success *out receives a new context; on DFA_ERR_FORMAT, *errorLine
+// (if not NULL) gets the line.
+// Lit un automate au format texte ci-dessous depuis in, en flux  travers
+// un tampon de taille fixe vers la table de transition ; la mmoire en plus
+// de l'automate reste borne. Les alphabets d'au moins 65536 symboles sont
+// compresss, leurs plages appliques par dfaSetTransitionRanges() par
+// lots d'au plus 65536. En cas de succs *out reoit un nouveau contexte ;
+// sur DFA_ERR_FORMAT, *errorLine (si non NULL) reoit la ligne fautive.
+//
+//   # comment                 '#' starts a comment / commentaire
+//   states 6                  state count / nombre d'tats
+//   alphabet 2                symbols 0..1 / symboles 0..1
+//   initial 0                 start state / tat initial
+//   final 1 2 4               final states, may be empty / tats finaux
+//   output 3 -2               optional output class / classe de sortie
+//   0 0 3                     transition: source symbol target / transition
+//   0 4-9 2                   symbols 4 to 9 at once / symboles 4  9 d'un coup
+DfaStatus dfaLoadText(FILE *in, DfaMinimizer **out, size_t *errorLine);
+
+// Binary format (native byte order, checked on load): a fixed header, then
+// the symbol intervals and their classes (if compressed), the transition table, the finality
+// bitset and optionally the state names and output classes, each 8-byte
+// aligned. Files start with DFA_BINARY_MAGIC.
+// Format binaire (ordre des octets natif, vrifi au chargement) : un
+// en-tte fixe, puis les intervalles de symboles et leurs classes (si
+// compress), la table de
+// transition, l'ensemble des finaux et ventuellement les noms et les
+// classes de sortie, chacun align sur 8 octets. Les fichiers commencent par DFA_BINARY_MAGIC.
+#define DFA_BINARY_MAGIC   "DFAMINB\n"
+#define DFA_BINARY_VERSION 3u
+
+// Writes the DFA (without its partition) in the binary format
+// crit l'automate (sans sa partition) au format binaire
+DfaStatus dfaSaveBinary(const DfaMinimizer *dfa, FILE *out);
+
+// Maps a binary file into a new context without copying or parsing it: the
+// arrays point into a private mapping (pages shared between processes until
+// written), and are copied to the heap only when a state is added or the
+// alphabet is compressed or expanded. The file is validated first.
+// Projette un fichier binaire dans un nouveau contexte sans copie ni
+// analyse : les tableaux pointent dans une projection prive (pages
+// partages entre processus tant qu'elles ne sont pas crites), et ne sont
+// copis sur le tas qu' l'ajout d'un tat ou  la (d)compression de
+// l'alphabet. Le fichier est valid au pralable.
+DfaStatus dfaLoadBinary(const char *path, DfaMinimizer **out);
+
+// Opaque NFA: several initial states and several targets per (state,
+// symbol) are allowed. Used as input to dfaBrzozowski().
+// Automate non dterministe opaque : plusieurs tats initiaux et plusieurs
+// cibles par (tat, symbole) sont permis. Sert d'entre  dfaBrzozowski().
+typedef struct DfaNfa DfaNfa;
+
+// Creates an empty NFA over symbols 0..alphabetSize-1 (NULL if 0)
+// Cre un automate non dterministe vide sur les symboles 0..alphabetSize-1 (NULL si 0)
+DfaNfa *dfaNfaCreate(uint32_t alphabetSize);
+
+// Releases an NFA
+// Libre un automate non dterministe
+void dfaNfaDestroy(DfaNfa *nfa);
+
+// Adds count non-initial, non-final states and returns the first id
+// (DFA_NO_STATE if count is 0 or too large)
+// Ajoute count tats ni initiaux ni finaux et renvoie le premier numro
+// (DFA_NO_STATE si count vaut 0 ou est trop grand)
+uint32_t dfaNfaAddStates(DfaNfa *nfa, uint32_t count);
+
+// Marks a state as initial / final or not
+// Marque un tat comme initial / final ou non
+DfaStatus dfaNfaSetInitial(DfaNfa *nfa, uint32_t state, bool isInitial);
+DfaStatus dfaNfaSetFinal(DfaNfa *nfa, uint32_t state, bool isFinal);
+
+// Adds the transition from on sym to to (duplicates are harmless)
+// Ajoute la transition de from par sym vers to (les doublons sont sans effet)
+DfaStatus dfaNfaAddTransition(DfaNfa *nfa, uint32_t from, int sym, uint32_t to);
+
+// Queries on the NFA
+// Requtes sur l'automate non dterministe
+uint32_t dfaNfaStateCount(const DfaNfa *nfa);
+bool     dfaNfaIsInitial(const DfaNfa *nfa, uint32_t state);
+bool     dfaNfaIsFinal(const DfaNfa *nfa, uint32_t state);
+
+// Reads an NFA in the text format of dfaLoadText(), except that the
+// "initial" line may list several states, a (source, symbol) pair may
+// have several targets and "output" lines are rejected. A range line adds
+// one edge per symbol; the alphabet is never compressed
+// Lit un automate non dterministe au format texte de dfaLoadText(), sauf
+// que la ligne "initial" peut lister plusieurs tats, qu'un couple
+// (source, symbole) peut avoir plusieurs cibles et que les lignes "output"
+// sont refuses. Une ligne de plage ajoute un arc par symbole ; l'alphabet
+// n'est jamais compress
+DfaStatus dfaNfaLoadText(FILE *in, DfaNfa **out, size_t *errorLine);
+
+// Minimal DFA of the NFA's language by Brzozowski's method (reverse,
+// determinize, reverse, determinize), as a new context: state 0 is initial,
+// states are unnamed, and missing transitions lead to the implicit
+// sink. Subsets are hash-consed; no intermediate DFA of the NFA itself is
+// built. The result may be exponentially larger than the NFA.
+// Automate minimal du langage de l'automate non dterministe par la
+// mthode de Brzozowski (renverser, dterminiser, deux fois), dans un
+// nouveau contexte : l'tat 0 est initial, les tats sont sans nom et
+// les transitions absentes mnent au puits implicite. Les sous-ensembles
+// sont partags par hachage ; aucun automate dterministe intermdiaire de
+// l'automate lui-mme n'est construit.
+DfaMinimizer *dfaBrzozowski(const DfaNfa *nfa);
+
+// Quotient of the NFA by its coarsest bisimulation, as a new NFA: states
+// are merged when they agree on finality and every symbol leads them into
+// the same classes. The language is kept, and determinizing the quotient
+// costs less. Paige-Tarjan refinement with edge counters per compound
+// block, O(m log n) for m distinct edges; classes are numbered by first
+// occurrence in state order.
+// Quotient de l'automate non dterministe par sa bisimulation la plus
+// grossire, dans un nouvel automate : les tats sont fusionns quand ils
+// s'accordent sur la finalit et que chaque symbole les mne dans les mmes
+// classes. Le langage est conserv, et dterminiser le quotient cote
+// moins. Raffinement de Paige-Tarjan avec compteurs d'arcs par bloc
+// compos, O(m log n) pour m arcs distincts ; les classes sont numrotes
+// par premire apparition dans l'ordre des tats.
+DfaNfa *dfaNfaBisimulation(const DfaNfa *nfa);
+
+// Opaque incremental builder of the minimal DFA (DAWG) of a sorted word
+// list, after Daciuk et al.: states off the path of the last word are
+// kept in a register of unique states, so memory stays near the size of
+// the minimal DFA and no trie is ever built.
+// Constructeur incrmental opaque de l'automate minimal (DAWG) d'une liste
+// de mots trie, d'aprs Daciuk et al. : les tats hors du chemin du
+// dernier mot sont gards dans un registre d'tats uniques ; la mmoire
+// reste proche de la taille de l'automate minimal, sans jamais de trie.
+typedef struct DfaDawgBuilder DfaDawgBuilder;
+
+// Creates a builder over symbols 0..alphabetSize-1 (NULL if 0)
+// Cre un constructeur sur les symboles 0..alphabetSize-1 (NULL si 0)
+DfaDawgBuilder *dfaDawgCreate(uint32_t alphabetSize);
+
+// Releases a builder
+// Libre un constructeur
+void dfaDawgDestroy(DfaDawgBuilder *builder);
+
+// Adds a word of length symbols. Words must come in increasing
+// lexicographic order of their symbols (DFA_ERR_INVALID otherwise, as
+// after dfaDawgFinish()); a repeated word is ignored.
+// Ajoute un mot de length symboles. Les mots doivent venir dans l'ordre
+// lexicographique croissant de leurs symboles (sinon DFA_ERR_INVALID, de
+// mme aprs dfaDawgFinish()) ; un mot rpt est ignor.
+DfaStatus dfaDawgAddWord(DfaDawgBuilder *builder, const int *word, size_t length);
+
+// Number of words added so far (repeats excluded)
+// Nombre de mots ajouts jusqu'ici (rptitions exclues)
+size_t dfaDawgWordCount(const DfaDawgBuilder *builder);
+
+// Builds the minimal DFA of the words added as a new context: state 0 is
+// initial, states are numbered in breadth-first order, and missing
+// transitions lead to the implicit sink. Later dfaDawgAddWord() calls fail.
+// Construit l'automate minimal des mots ajouts dans un nouveau contexte :
+// l'tat 0 est initial, les tats sont numrots en largeur d'abord et les
+// transitions absentes mnent au puits implicite. Les appels suivants 
+// dfaDawgAddWord() chouent.
+DfaMinimizer *dfaDawgFinish(DfaDawgBuilder *builder);
+
+// Per-DFA outcome of a batch run
+// Rsultat par automate d'un traitement par lot
+typedef struct {
+    DfaStatus status;          // Status of the trim + minimize pipeline
+    int       partitionCount;  // Number of states of the minimized DFA
+} DfaBatchResult;
+
+// Trims and minimizes count independent DFAs on a work-stealing pool of
+// nThreads threads (0: one per online CPU, the caller included). results[i]
+// describes dfas[i]; each context is touched by exactly one thread.
+// Nettoie et minimise count automates indpendants sur un pool de nThreads
+// threads avec vol de travail (0 : un par processeur, appelant compris).
+// results[i] dcrit dfas[i] ; chaque contexte n'est trait que par un thread.
+DfaStatus dfaMinimizeBatch(DfaMinimizer *const *dfas, size_t count, DfaEngine engine,
+                           bool dropDead, int nThreads, DfaBatchResult *results);
+
+#endif
@@ -0,0 +1,86 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <string.h>
+
+static inline bool testBit(const uint64_t *bits, uint32_t i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline void assignBit(uint64_t *bits, uint32_t i, bool value) {
+    if (value) bits[i >> 6] |= UINT64_C(1) << (i & 63);
+    else bits[i >> 6] &= ~(UINT64_C(1) << (i & 63));
+}
+
+DfaNfa *dfaNfaCreate(uint32_t alphabetSize) {
+    if (alphabetSize == 0 || alphabetSize > INT32_MAX) return NULL;
+    DfaNfa *nfa = xcalloc(1, sizeof(DfaNfa));
+    nfa->alphabetSize = alphabetSize;
+    return nfa;
+}
+
+void dfaNfaDestroy(DfaNfa *nfa) {
+    if (!nfa) return;
+    free(nfa->initialBits);
+    free(nfa->finalBits);
+    free(nfa->edges);
+    free(nfa);
+}
+
+uint32_t dfaNfaAddStates(DfaNfa *nfa, uint32_t count) {
+    uint64_t needed = (uint64_t)nfa->nStates + count;
+    if (count == 0 || needed >= DFA_NO_STATE) return DFA_NO_STATE;
+    if (needed > nfa->statesCapacity) {
+        uint64_t capacity = nfa->statesCapacity ? nfa->statesCapacity : 64;
+        while (capacity < needed) capacity *= 2;
+        if (capacity > DFA_NO_STATE) capacity = DFA_NO_STATE;
+        uint32_t oldWords = (nfa->statesCapacity + 63) / 64;
+        uint32_t words = (uint32_t)((capacity + 63) / 64);
+        nfa->initialBits = xrealloc(nfa->initialBits, words, sizeof(uint64_t));
+        nfa->finalBits = xrealloc(nfa->finalBits, words, sizeof(uint64_t));
+        memset(nfa->initialBits + oldWords, 0, (words - oldWords) * sizeof(uint64_t));
+        memset(nfa->finalBits + oldWords, 0, (words - oldWords) * sizeof(uint64_t));
+        nfa->statesCapacity = (uint32_t)capacity;
+    }
+    uint32_t firstId = nfa->nStates;
+    nfa->nStates += count;
+    return firstId;
+}
+
+DfaStatus dfaNfaSetInitial(DfaNfa *nfa, uint32_t state, bool isInitial) {
+    if (state >= nfa->nStates) return DFA_ERR_INVALID;
+    assignBit(nfa->initialBits, state, isInitial);
+    return DFA_OK;
+}
+
+DfaStatus dfaNfaSetFinal(DfaNfa *nfa, uint32_t state, bool isFinal) {
+    if (state >= nfa->nStates) return DFA_ERR_INVALID;
+    assignBit(nfa->finalBits, state, isFinal);
+    return DFA_OK;
+}
+
+DfaStatus dfaNfaAddTransition(DfaNfa *nfa, uint32_t from, int sym, uint32_t to) {
+    if (from >= nfa->nStates || to >= nfa->nStates || sym < 0 || (uint32_t)sym >= nfa->alphabetSize) {
+        return DFA_ERR_INVALID;
+    }
+    if (nfa->nEdges == nfa->edgesCapacity) {
+        nfa->edgesCapacity = nfa->edgesCapacity ? nfa->edgesCapacity * 2 : 256;
+        nfa->edges = xrealloc(nfa->edges, nfa->edgesCapacity, sizeof(NfaEdge));
+    }
+    nfa->edges[nfa->nEdges++] = (NfaEdge){ from, (uint32_t)sym, to };
+    return DFA_OK;
+}
+
+uint32_t dfaNfaStateCount(const DfaNfa *nfa) {
+    return nfa->nStates;
+}
+
+bool dfaNfaIsInitial(const DfaNfa *nfa, uint32_t state) {
+    return state < nfa->nStates && testBit(nfa->initialBits, state);
+}
+
+bool dfaNfaIsFinal(const DfaNfa *nfa, uint32_t state) {
+    return state < nfa->nStates && testBit(nfa->finalBits, state);
+}
@@ -0,0 +1,500 @@
+/*
+By Ed-dahmani Soulaimane
+*/
+#include "DFA_Internal.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PARALLEL_MIN_STATES_PER_THREAD 4096   // Below this, extra threads cost more than they save
+#define PARALLEL_MIN_SPLITTERS 256             // Smaller worklists are processed by thread 0 alone
+#define EMPTY_SLOT UINT32_MAX
+
+// A team of threads running the same task in barrier-separated phases;
+// the calling thread is member 0. Members wait at a start gate until the
+// team size is final, so threads that fail to start are simply left out.
+// quipe de threads excutant la mme tche en phases spares par des
+// barrires ; le thread appelant est le membre 0. Les membres attendent 
+// une porte de dpart que la taille de l'quipe soit fixe : les threads
+// qui ne dmarrent pas sont simplement carts.
+typedef struct ThreadTeam ThreadTeam;
+typedef void (*TeamTask)(void *job, ThreadTeam *team, int self);
+
+struct ThreadTeam {
+    TeamTask task;
+    void *job;
+    int nThreads;               // Members actually running
+    pthread_barrier_t barrier;
+    pthread_mutex_t startLock;
+    pthread_cond_t startCond;
+    bool started;
+};
+
+typedef struct {
+    ThreadTeam *team;
+    int self;
+} TeamMember;
+
+// Team size: the context's setting or one per CPU, capped so that each
+// member gets at least grain units of work
+// Taille de l'quipe : le rglage du contexte ou un par processeur, borne
+// pour que chaque membre ait au moins grain units de travail
+static int teamSize(const DfaMinimizer *d, uint64_t work, uint64_t grain) {
+    int nThreads = d->nThreads;
+    if (nThreads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nThreads = online > 0 ? (int)online : 1;
+    }
+    uint64_t maxThreads = work / grain;
+    if ((uint64_t)nThreads > maxThreads) nThreads = maxThreads ? (int)maxThreads : 1;
+    return nThreads;
+}
+
+static void *teamMain(void *arg) {
+    TeamMember *m = arg;
+    ThreadTeam *team = m->team;
+    pthread_mutex_lock(&team->startLock);
+    while (!team->started) pthread_cond_wait(&team->startCond, &team->startLock);
+    pthread_mutex_unlock(&team->startLock);
+    team->task(team->job, team, m->self);
+    return NULL;
+}
+
+// Runs task on up to nThreads members and returns when all have finished
+// Excute task sur au plus nThreads membres et revient quand tous ont fini
+static void runTeam(TeamTask task, void *job, int nThreads) {
+    ThreadTeam team;
+    team.task = task;
+    team.job = job;
+    team.started = false;
+    pthread_mutex_init(&team.startLock, NULL);
+    pthread_cond_init(&team.startCond, NULL);
+    TeamMember *members = xcalloc((size_t)nThreads, sizeof(TeamMember));
+    pthread_t *threads = xcalloc((size_t)nThreads, sizeof(pthread_t));
+    for (int t = 0; t < nThreads; ++t) {
+        members[t].team = &team;
+        members[t].self = t;
+    }
+    int running = 1;
+    for (int t = 1; t < nThreads; ++t, ++running) {
+        if (pthread_create(&threads[t], NULL, teamMain, &members[t]) != 0) break;
+    }
+    team.nThreads = running;
+    pthread_barrier_init(&team.barrier, NULL, (unsigned)running);
+    pthread_mutex_lock(&team.startLock);
+    team.started = true;
+    pthread_cond_broadcast(&team.startCond);
+    pthread_mutex_unlock(&team.startLock);
+
+    teamMain(&members[0]);
+    for (int t = 1; t < running; ++t) pthread_join(threads[t], NULL);
+    pthread_barrier_destroy(&team.barrier);
+    pthread_cond_destroy(&team.startCond);
+    pthread_mutex_destroy(&team.startLock);
+    free(threads);
+    free(members);
+}
+
+// Range [lo, hi) of count items handled by member self
+// Plage [lo, hi) des count lments traits par le membre self
+static inline void teamRange(const ThreadTeam *team, int self, uint64_t count, uint64_t *lo, uint64_t *hi) {
+    *lo = count * (uint64_t)self / (uint64_t)team->nThreads;
+    *hi = count * (uint64_t)(self + 1) / (uint64_t)team->nThreads;
+}
+
+// Shared state of one parallel Moore refinement. Every round runs in
+// barrier-separated phases over fixed state ranges, one per thread:
+//   1. clear the signature table
+//   2. insert each state; a slot keeps the smallest state of its class
+//   3. count, per range, the states that are their class minimum (leaders)
+//   4. prefix sum of the counts (thread 0)
+//   5. number leaders in state order, then copy the id to the other states
+// Blocks are thus numbered by first occurrence in state order, whatever
+// the thread count or scheduling.
+// tat partag d'un raffinement de Moore parallle. Chaque passe s'excute
+// en phases spares par des barrires sur des plages d'tats fixes, une
+// par thread :
+//   1. vide la table des signatures
+//   2. insre chaque tat ; une case garde le plus petit tat de sa classe
+//   3. compte, par plage, les tats minimums de leur classe (meneurs)
+//   4. somme prfixe des comptes (thread 0)
+//   5. numrote les meneurs dans l'ordre des tats, puis recopie le numro
+//      aux autres tats
+// Les blocs sont donc numrots par premire apparition dans l'ordre des
+// tats, quels que soient le nombre de threads et l'ordonnancement.
+typedef struct {
+    const DfaMinimizer *d;
+    uint32_t *blockOf;          // Blocks of the previous round
+    uint32_t *nextBlockOf;      // Blocks being computed
+    _Atomic uint32_t *table;    // Signature hash table of state ids
+    uint32_t tableMask;
+    uint32_t *slotOf;           // Table slot of each state's class
+    uint32_t *leaderCount;      // Leaders per range, then range start ids
+    uint32_t nBlocks;
+    bool changed;
+} ParallelMoore;
+
+// Hash of the whole signature of s
+// Hachage de toute la signature de s
+DFA_ALWAYS_INLINE uint64_t digitsHash(const DfaMinimizer *d, const uint32_t *blockOf, uint32_t s, const uint32_t k) {
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    for (uint32_t digit = 0; digit <= k; ++digit) {
+        h = (h ^ signatureDigit(d, blockOf, s, digit, k)) * UINT64_C(0x100000001b3);
+    }
+    return h ^ (h >> 31);
+}
+
+DFA_ALWAYS_INLINE bool sameDigits(const DfaMinimizer *d, const uint32_t *blockOf, uint32_t s, uint32_t t,
+                                  const uint32_t k) {
+    for (uint32_t digit = 0; digit <= k; ++digit) {
+        if (signatureDigit(d, blockOf, s, digit, k) != signatureDigit(d, blockOf, t, digit, k)) return false;
+    }
+    return true;
+}
+
+// Inserts s in the concurrent table and returns the slot of its class,
+// lowering the slot's state to s when s is smaller
+// Insre s dans la table concurrente et renvoie la case de sa classe, en y
+// abaissant l'tat  s s'il est plus petit
+DFA_ALWAYS_INLINE uint32_t insertState(ParallelMoore *job, uint32_t s, const uint32_t k) {
+    uint32_t slot = (uint32_t)digitsHash(job->d, job->blockOf, s, k) & job->tableMask;
+    for (;;) {
+        uint32_t v = atomic_load_explicit(&job->table[slot], memory_order_relaxed);
+        if (v == EMPTY_SLOT) {
+            if (atomic_compare_exchange_strong(&job->table[slot], &v, s)) return slot;
+            // Lost the race: v now holds the winner, examined below
+            // Course perdue : v contient le gagnant, examin ci-dessous
+        }
+        if (sameDigits(job->d, job->blockOf, s, v, k)) {
+            // Only states of this class are ever stored here, so retrying
+            // with the reloaded value keeps the minimum
+            // Seuls des tats de cette classe sont stocks ici : ressayer
+            // avec la valeur relue conserve le minimum
+            while (s < v && !atomic_compare_exchange_weak(&job->table[slot], &v, s)) {}
+            return slot;
+        }
+        slot = (slot + 1) & job->tableMask;
+    }
+}
+
+DFA_ALWAYS_INLINE void parallelMooreRounds(ParallelMoore *job, ThreadTeam *team, int self, const uint32_t k) {
+    uint64_t lo, hi, tableLo, tableHi;
+    teamRange(team, self, job->d->nStates, &lo, &hi);
+    teamRange(team, self, (uint64_t)job->tableMask + 1, &tableLo, &tableHi);
+
+    for (;;) {
+        for (uint64_t i = tableLo; i < tableHi; ++i) {
+            atomic_store_explicit(&job->table[i], EMPTY_SLOT, memory_order_relaxed);
+        }
+        pthread_barrier_wait(&team->barrier);
+
+        for (uint32_t s = (uint32_t)lo; s < hi; ++s) job->slotOf[s] = insertState(job, s, k);
+        pthread_barrier_wait(&team->barrier);
+
+        uint32_t leaders = 0;
+        for (uint32_t s = (uint32_t)lo; s < hi; ++s) {
+            leaders += atomic_load_explicit(&job->table[job->slotOf[s]], memory_order_relaxed) == s;
+        }
+        job->leaderCount[self] = leaders;
+        pthread_barrier_wait(&team->barrier);
+
+        if (self == 0) {
+            uint32_t total = 0;
+            for (int t = 0; t < team->nThreads; ++t) {
+                uint32_t c = job->leaderCount[t];
+                job->leaderCount[t] = total;
+                total += c;
+            }
+            job->changed = total != job->nBlocks;
+            job->nBlocks = total;
+        }
+        pthread_barrier_wait(&team->barrier);
+
+        uint32_t id = job->leaderCount[self];
+        for (uint32_t s = (uint32_t)lo; s < hi; ++s) {
+            if (atomic_load_explicit(&job->table[job->slotOf[s]], memory_order_relaxed) == s) job->nextBlockOf[s] = id++;
+        }
+        pthread_barrier_wait(&team->barrier);
+
+        // Leaders are final now: other states read their leader's id
+        // Les meneurs sont fixs : les autres tats lisent le numro du leur
+        for (uint32_t s = (uint32_t)lo; s < hi; ++s) {
+            uint32_t leader = atomic_load_explicit(&job->table[job->slotOf[s]], memory_order_relaxed);
+            if (leader != s) job->nextBlockOf[s] = job->nextBlockOf[leader];
+        }
+        pthread_barrier_wait(&team->barrier);
+
+        if (self == 0) {
+            uint32_t *swap = job->blockOf;
+            job->blockOf = job->nextBlockOf;
+            job->nextBlockOf = swap;
+        }
+        pthread_barrier_wait(&team->barrier);
+        if (!job->changed) return;
+    }
+}
+
+static void parallelMooreTask(void *arg, ThreadTeam *team, int self) {
+    ParallelMoore *job = arg;
+    DISPATCH_ALPHABET(job->d->nClasses, parallelMooreRounds, job, team, self);
+}
+
+uint32_t dfaParallelMooreBlocks(DfaMinimizer *d, uint32_t *blockOf) {
+    uint32_t n = d->nStates;
+    if (n == 0) return 0;
+
+    int nThreads = teamSize(d, n, PARALLEL_MIN_STATES_PER_THREAD);
+
+    ParallelMoore job;
+    job.d = d;
+    job.blockOf = blockOf;
+    ArenaMark mark = arenaMark(&d->scratch);
+    job.nextBlockOf = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    uint64_t tableSize = 1;
+    while (tableSize < 2 * (uint64_t)n) tableSize *= 2;
+    job.table = arenaAlloc(&d->scratch, tableSize, sizeof(*job.table));
+    job.tableMask = (uint32_t)(tableSize - 1);
+    job.slotOf = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    job.leaderCount = arenaAlloc(&d->scratch, (size_t)nThreads, sizeof(uint32_t));
+    job.nBlocks = d->partition.nBlocks;
+    job.changed = false;
+    memcpy(blockOf, d->partition.sidx, n * sizeof(uint32_t));
+
+    runTeam(parallelMooreTask, &job, nThreads);
+
+    // The result may sit in either buffer after the last swap
+    // Le rsultat peut se trouver dans l'un ou l'autre tampon aprs le dernier change
+    if (job.blockOf != blockOf) memcpy(blockOf, job.blockOf, n * sizeof(uint32_t));
+    arenaRelease(&d->scratch, mark);
+    return job.nBlocks;
+}
+
+// Growable list of 64-bit items
+// Liste extensible d'lments de 64 bits
+typedef struct {
+    uint64_t *items;
+    size_t count, capacity;
+} ItemList;
+
+static inline void itemPush(ItemList *list, uint64_t item) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? 2 * list->capacity : 256;
+        list->items = xrealloc(list->items, list->capacity, sizeof(uint64_t));
+    }
+    list->items[list->count++] = item;
+}
+
+// Shared state of one parallel Hopcroft refinement over a refinable
+// partition of the states and the virtual sink. Pending splitters are taken in batches:
+//   1. each thread computes the preimages of a share of the batch, filing
+//      every predecessor under the thread that owns its block
+//      (block % nThreads) and under its splitter's index
+//   2. each thread marks and splits only the blocks it owns, splitter by
+//      splitter in batch order; new block ids come from an atomic counter
+//      and new splitters go to per-thread lists
+//   3. thread 0 merges those lists into the worklist
+// A splitter's preimage is read before any split of the batch, which is
+// sound: every split is by a union of blocks of the current partition.
+// Small worklists are processed by thread 0 alone, one splitter at a time.
+// tat partag d'un raffinement de Hopcroft parallle sur une partition
+// raffinable des tats et du puits virtuel. Les sparateurs en attente
+// sont pris par lots :
+//   1. chaque thread calcule les primages d'une part du lot, rangeant
+//      chaque prdcesseur chez le thread propritaire de son bloc
+//      (bloc % nThreads) avec le rang de son sparateur
+//   2. chaque thread marque et divise seulement ses blocs, sparateur par
+//      sparateur dans l'ordre du lot ; les nouveaux blocs sont numrots
+//      par un compteur atomique, les nouveaux sparateurs vont dans des
+//      listes par thread
+//   3. le thread 0 fusionne ces listes dans la liste de travail
+// La primage d'un sparateur est lue avant toute division du lot, ce qui
+// est correct : chaque division se fait par une union de blocs de la
+// partition courante. Les petites listes sont traites par le thread 0
+// seul, un sparateur  la fois.
+typedef struct {
+    const DfaMinimizer *d;
+    const uint32_t *predStart, *preds;  // Shared inverse transitions, sink included
+    RefinablePartition part;            // Block ids beyond part.nBlocks come from nBlocks
+    _Atomic uint32_t nBlocks;
+    size_t *work;                       // Pending splitters block * k + symbol
+    size_t nWork;
+    size_t *batch;                      // Splitters of the current batch
+    size_t nBatch;
+    ItemList *buckets;                  // [producer * nThreads + owner]: index << 32 | state
+    ItemList *pushes;                   // New splitters per thread
+    uint32_t *touched;                  // nThreads lists of n touched blocks
+    uint32_t *buffer;                   // Preimage of a single splitter
+    bool done;
+} ParallelHopcroft;
+
+// Splits the touched blocks, new blocks taking ids from the shared counter
+// and their splitters going to pushes
+// Divise les blocs touchs, les nouveaux blocs prenant leur numro au
+// compteur partag et leurs sparateurs allant dans pushes
+DFA_ALWAYS_INLINE void splitTouched(ParallelHopcroft *job, uint32_t *touched, uint32_t nTouched, ItemList *pushes,
+                                    const uint32_t k) {
+    RefinablePartition *p = &job->part;
+    while (nTouched > 0) {
+        uint32_t b = touched[--nTouched];
+        uint32_t z = p->mid[b] == p->end[b] ? DFA_NO_STATE
+                                            : atomic_fetch_add_explicit(&job->nBlocks, 1, memory_order_relaxed);
+        if (!refinableSplit(p, b, z)) continue;
+        for (uint32_t c = 0; c < k; ++c) itemPush(pushes, (uint64_t)z * k + c);
+    }
+}
+
+// Thread 0 between batches: merges new splitters, processes a small
+// worklist alone, then hands the remaining worklist over as the next batch
+// Thread 0 entre deux lots : fusionne les nouveaux sparateurs, traite seul
+// une petite liste, puis en fait le lot suivant
+DFA_ALWAYS_INLINE void prepareBatch(ParallelHopcroft *job, ThreadTeam *team, const uint32_t k) {
+    for (int t = 0; t < team->nThreads; ++t) {
+        for (size_t i = 0; i < job->pushes[t].count; ++i) job->work[job->nWork++] = job->pushes[t].items[i];
+        job->pushes[t].count = 0;
+    }
+
+    RefinablePartition *p = &job->part;
+    uint32_t nTouched = 0;
+    while (job->nWork > 0 && job->nWork < PARALLEL_MIN_SPLITTERS) {
+        size_t splitter = job->work[--job->nWork];
+        uint32_t A = (uint32_t)(splitter / k);
+        uint32_t sym = (uint32_t)(splitter % k);
+        uint32_t nPre = 0;
+        for (uint32_t e = p->first[A]; e < p->end[A]; ++e) {
+            size_t slot = (size_t)p->elems[e] * k + sym;
+            for (uint32_t i = job->predStart[slot]; i < job->predStart[slot + 1]; ++i) {
+                job->buffer[nPre++] = job->preds[i];
+            }
+        }
+        for (uint32_t i = 0; i < nPre; ++i) refinableMark(p, job->buffer[i], job->touched, &nTouched);
+        splitTouched(job, job->touched, nTouched, &job->pushes[0], k);
+        nTouched = 0;
+        for (size_t i = 0; i < job->pushes[0].count; ++i) job->work[job->nWork++] = job->pushes[0].items[i];
+        job->pushes[0].count = 0;
+    }
+
+    // Both arrays hold up to n * k splitters: swap rather than copy
+    // Les deux tableaux contiennent jusqu' n * k sparateurs : change plutt que copie
+    size_t *swap = job->batch;
+    job->batch = job->work;
+    job->nBatch = job->nWork;
+    job->work = swap;
+    job->nWork = 0;
+    job->done = job->nBatch == 0;
+}
+
+DFA_ALWAYS_INLINE void parallelHopcroftRounds(ParallelHopcroft *job, ThreadTeam *team, int self, const uint32_t k) {
+    uint32_t nThreads = (uint32_t)team->nThreads;
+    uint32_t n = job->d->nStates + 1;
+    uint32_t *touched = job->touched + (size_t)self * n;
+    RefinablePartition *part = &job->part;
+
+    for (;;) {
+        if (self == 0) prepareBatch(job, team, k);
+        pthread_barrier_wait(&team->barrier);
+        if (job->done) return;
+
+        // Preimages of this thread's share of the batch, by owner
+        // Primages de la part du lot de ce thread, par propritaire
+        uint64_t lo, hi;
+        teamRange(team, self, job->nBatch, &lo, &hi);
+        ItemList *out = job->buckets + (size_t)self * nThreads;
+        for (uint64_t j = lo; j < hi; ++j) {
+            uint32_t A = (uint32_t)(job->batch[j] / k);
+            uint32_t sym = (uint32_t)(job->batch[j] % k);
+            for (uint32_t e = part->first[A]; e < part->end[A]; ++e) {
+                size_t slot = (size_t)part->elems[e] * k + sym;
+                for (uint32_t p = job->predStart[slot]; p < job->predStart[slot + 1]; ++p) {
+                    uint32_t s = job->preds[p];
+                    itemPush(&out[part->sidx[s] % nThreads], j << 32 | s);
+                }
+            }
+        }
+        pthread_barrier_wait(&team->barrier);
+
+        // Split owned blocks, one splitter at a time; producers cover
+        // increasing index ranges, so batch order is preserved
+        // Divise les blocs possds, un sparateur  la fois ; les
+        // producteurs couvrent des rangs croissants : l'ordre du lot est conserv
+        uint32_t nTouched = 0;
+        for (uint32_t t = 0; t < nThreads; ++t) {
+            ItemList *in = &job->buckets[(size_t)t * nThreads + (uint32_t)self];
+            for (size_t i = 0; i < in->count; ++i) {
+                refinableMark(part, (uint32_t)in->items[i], touched, &nTouched);
+                if (i + 1 == in->count || (in->items[i + 1] >> 32) != (in->items[i] >> 32)) {
+                    splitTouched(job, touched, nTouched, &job->pushes[self], k);
+                    nTouched = 0;
+                }
+            }
+            in->count = 0;
+        }
+        pthread_barrier_wait(&team->barrier);
+    }
+}
+
+static void parallelHopcroftTask(void *arg, ThreadTeam *team, int self) {
+    ParallelHopcroft *job = arg;
+    DISPATCH_ALPHABET(job->d->nClasses, parallelHopcroftRounds, job, team, self);
+}
+
+uint32_t dfaParallelHopcroftBlocks(DfaMinimizer *d, uint32_t *blockOf) {
+    if (d->nStates == 0) return 0;
+    uint32_t k = d->nClasses;
+    uint32_t n = d->nStates + 1;      // Real states plus the virtual sink
+    uint32_t sink = d->nStates;
+    size_t slots = (size_t)n * k;
+    int nThreads = teamSize(d, n, PARALLEL_MIN_STATES_PER_THREAD);
+
+    ParallelHopcroft job;
+    job.d = d;
+
+    // The caller has built the shared inverse index
+    // L'appelant a construit l'index inverse partag
+    job.predStart = d->predStart;
+    job.preds = d->preds;
+
+    // Current blocks plus the virtual sink in a block of its own
+    // Blocs courants plus le puits virtuel dans son propre bloc
+    memset(&job.part, 0, sizeof(job.part));
+    ArenaMark mark = arenaMark(&d->scratch);
+    job.buffer = arenaAlloc(&d->scratch, n, sizeof(uint32_t));
+    memcpy(job.buffer, d->partition.sidx, d->nStates * sizeof(uint32_t));
+    job.buffer[sink] = d->partition.nBlocks;
+    refinableInit(&job.part, n, job.buffer, d->partition.nBlocks + 1, &d->scratch);
+    uint32_t nBlocks = job.part.nBlocks;
+
+    // Every (block, symbol) pair is queued at most once, hence n * k slots
+    // Chaque paire (bloc, symbole) est mise en attente au plus une fois : n * k cases
+    job.work = arenaAlloc(&d->scratch, slots, sizeof(size_t));
+    job.batch = arenaAlloc(&d->scratch, slots, sizeof(size_t));
+    job.nWork = job.nBatch = 0;
+    uint32_t largest = 0;
+    for (uint32_t b = 1; b < nBlocks; ++b) {
+        if (job.part.end[b] - job.part.first[b] > job.part.end[largest] - job.part.first[largest]) largest = b;
+    }
+    for (uint32_t b = 0; b < nBlocks; ++b) {
+        if (b == largest) continue;
+        for (uint32_t sym = 0; sym < k; ++sym) job.work[job.nWork++] = (size_t)b * k + sym;
+    }
+    atomic_init(&job.nBlocks, nBlocks);
+
+    job.buckets = arenaAlloc(&d->scratch, (size_t)nThreads * nThreads, sizeof(ItemList));
+    job.pushes = arenaAlloc(&d->scratch, (size_t)nThreads, sizeof(ItemList));
+    job.touched = arenaAlloc(&d->scratch, (size_t)nThreads * n, sizeof(uint32_t));
+    job.done = false;
+
+    runTeam(parallelHopcroftTask, &job, nThreads);
+
+    // Block ids depend on scheduling: the caller renumbers them canonically
+    // Les numros de blocs dpendent de l'ordonnancement : l'appelant les renumrote
+    memcpy(blockOf, job.part.sidx, d->nStates * sizeof(uint32_t));
+    nBlocks = atomic_load(&job.nBlocks);
+
+    for (int t = 0; t < nThreads * nThreads; ++t) free(job.buckets[t].items);
+    for (int t = 0; t < nThreads; ++t) free(job.pushes[t].items);
+    arenaRelease(&d->scratch, mark);
+    refinableFree(&job.part);
+    return nBlocks;
+}